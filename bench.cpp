@@ -0,0 +1,310 @@
+﻿#include "parser.h"
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+
+// 스캐너 벤치마크
+//  합성 코퍼스를 메모리에 만들고 (파일 I/O 없음), 커널 × 스레드 수마다 InFileReserver::ScanBuffer 를
+//  반복 실행해 벽시계 시간으로 GB/s, 토큰/s, 스레드 확장 효율을 낸다.
+//  clock() 은 리눅스에서 모든 스레드의 CPU 시간 합이라 멀티스레드 비교에 쓸 수 없으므로 steady_clock 만 쓴다.
+//
+//  bench [코퍼스 크기(MiB), 기본 64] [반복 횟수, 기본 5] [최대 스레드 수, 기본 하드웨어 스레드 수] [코퍼스 이름 ...]
+
+namespace clau_bench {
+
+    // ----- 합성 코퍼스 -----
+    //  같은 시드로 항상 같은 입력을 만든다. 크기는 target 을 조금 넘는 선에서 값 경계로 끝낸다.
+    class Generator {
+    public:
+        explicit Generator(uint64_t seed) : rng(seed) {}
+
+        int64_t Int(int64_t lo, int64_t hi) { return std::uniform_int_distribution<int64_t>(lo, hi)(rng); }
+        double Real(double lo, double hi) { return std::uniform_real_distribution<double>(lo, hi)(rng); }
+
+        void Word(std::string& out) {
+            static const char* const words[] = {
+                "GET", "POST", "request", "user", "session", "timeout", "retry", "cache", "miss", "hit",
+                "upstream", "connection", "reset", "by", "peer", "latency", "shard", "replica", "commit", "abort",
+            };
+            out += words[Int(0, sizeof(words) / sizeof(words[0]) - 1)];
+        }
+
+        void Number(std::string& out, double value, int precision) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "%.*f", precision, value);
+            out += buf;
+        }
+
+    private:
+        std::mt19937_64 rng;
+    };
+
+    // citylots 비슷한 숫자 위주 좌표 (FeatureCollection / Polygon)
+    std::string MakeGeometry(int64_t target) {
+        Generator g(1);
+        std::string out = "{\"type\":\"FeatureCollection\",\"features\":[\n";
+        for (int64_t n = 0; static_cast<int64_t>(out.size()) < target; ++n) {
+            if (n > 0) out += ",\n";
+            out += "{\"type\":\"Feature\",\"properties\":{\"MAPBLKLOT\":\"";
+            out += std::to_string(g.Int(1000000, 9999999));
+            out += "\",\"BLOCK_NUM\":\"";
+            out += std::to_string(g.Int(1000, 9999));
+            out += "\",\"STREET\":\"";
+            g.Word(out);
+            out += "\",\"ODD_EVEN\":\"E\"},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[[";
+            const int64_t points = g.Int(4, 40);
+            for (int64_t p = 0; p < points; ++p) {
+                if (p > 0) out += ", ";
+                out += "[ ";
+                g.Number(out, g.Real(-122.52, -122.35), 15);
+                out += ", ";
+                g.Number(out, g.Real(37.70, 37.83), 15);
+                out += ", 0.0 ]";
+            }
+            out += "]]}}";
+        }
+        out += "\n]}\n";
+        return out;
+    }
+
+    // 문자열 위주 로그 (긴 메시지, 짧은 키)
+    std::string MakeLogs(int64_t target) {
+        Generator g(2);
+        std::string out = "[\n";
+        for (int64_t n = 0; static_cast<int64_t>(out.size()) < target; ++n) {
+            if (n > 0) out += ",\n";
+            out += "  {\"ts\":\"2024-05-01T12:";
+            out += std::to_string(g.Int(10, 59));
+            out += ":";
+            out += std::to_string(g.Int(10, 59));
+            out += ".123Z\",\"level\":\"";
+            out += g.Int(0, 9) == 0 ? "ERROR" : "INFO";
+            out += "\",\"host\":\"web-";
+            out += std::to_string(g.Int(1, 64));
+            out += "\",\"msg\":\"";
+            const int64_t words = g.Int(8, 40);
+            for (int64_t w = 0; w < words; ++w) {
+                if (w > 0) out += ' ';
+                g.Word(out);
+            }
+            out += "\",\"tags\":[\"";
+            g.Word(out);
+            out += "\",\"";
+            g.Word(out);
+            out += "\"]}";
+        }
+        out += "\n]\n";
+        return out;
+    }
+
+    // 깊은 중첩 (객체 / 배열을 번갈아 depth 단계, 안쪽은 짧은 값)
+    std::string MakeNested(int64_t target) {
+        Generator g(3);
+        std::string out = "[";
+        for (int64_t n = 0; static_cast<int64_t>(out.size()) < target; ++n) {
+            if (n > 0) out += ",";
+            const int64_t depth = g.Int(16, 64);
+            for (int64_t d = 0; d < depth; ++d) out += d % 2 == 0 ? "{\"k\":" : "[";
+            out += std::to_string(g.Int(0, 1000));
+            for (int64_t d = depth - 1; d >= 0; --d) out += d % 2 == 0 ? "}" : ",true]";
+        }
+        out += "]\n";
+        return out;
+    }
+
+    // escape 가 많은 문자열 (\" \\ \n \t \u)
+    std::string MakeEscapes(int64_t target) {
+        Generator g(4);
+        static const char* const pieces[] = {
+            "\\\"", "\\\\", "\\n", "\\t", "\\u00e9", "\\u4e2d", "\\/", "plain", " ", "\\\\\\\"",
+        };
+        std::string out = "[\n";
+        for (int64_t n = 0; static_cast<int64_t>(out.size()) < target; ++n) {
+            if (n > 0) out += ",\n";
+            out += "{\"text\":\"";
+            const int64_t count = g.Int(4, 32);
+            for (int64_t k = 0; k < count; ++k) out += pieces[g.Int(0, sizeof(pieces) / sizeof(pieces[0]) - 1)];
+            out += "\",\"path\":\"C:\\\\logs\\\\";
+            g.Word(out);
+            out += "\"}";
+        }
+        out += "\n]\n";
+        return out;
+    }
+
+    // NDJSON (줄마다 레코드 하나, SetJsonLines 로 스캔)
+    std::string MakeNdjson(int64_t target) {
+        Generator g(5);
+        std::string out;
+        while (static_cast<int64_t>(out.size()) < target) {
+            out += "{\"id\":";
+            out += std::to_string(g.Int(0, int64_t(1) << 40));
+            out += ",\"user\":\"";
+            g.Word(out);
+            out += "\",\"score\":";
+            g.Number(out, g.Real(0, 100), 3);
+            out += ",\"events\":[";
+            const int64_t events = g.Int(0, 6);
+            for (int64_t e = 0; e < events; ++e) {
+                if (e > 0) out += ",";
+                out += "{\"t\":";
+                out += std::to_string(g.Int(0, 1000000));
+                out += ",\"kind\":\"";
+                g.Word(out);
+                out += "\"}";
+            }
+            out += "],\"ok\":";
+            out += g.Int(0, 1) ? "true" : "false";
+            out += "}\n";
+        }
+        return out;
+    }
+
+    struct Corpus {
+        const char* name;
+        std::function<std::string(int64_t)> make;
+        bool json_lines;
+    };
+
+    // ----- 측정 -----
+    struct Result {
+        double best_ms = 0;
+        double median_ms = 0;
+        int64_t tokens = -1;  // -1 : 실패
+    };
+
+    Result Measure(int repeat, const std::function<int64_t()>& run) {
+        Result result;
+        std::vector<double> ms;
+        run();  // 예열 (워커 생성, 아레나 할당, 페이지 폴트)
+        for (int r = 0; r < repeat; ++r) {
+            const auto a = std::chrono::steady_clock::now();
+            const int64_t tokens = run();
+            const auto b = std::chrono::steady_clock::now();
+            if (tokens < 0) return result;
+            result.tokens = tokens;
+            ms.push_back(std::chrono::duration<double, std::milli>(b - a).count());
+        }
+        std::sort(ms.begin(), ms.end());
+        result.best_ms = ms.front();
+        result.median_ms = ms[ms.size() / 2];
+        return result;
+    }
+
+    void PrintHeader() {
+        std::cout << std::left << std::setw(10) << "corpus" << std::setw(8) << "kernel" << std::right
+            << std::setw(8) << "threads" << std::setw(11) << "best ms" << std::setw(11) << "median ms"
+            << std::setw(9) << "GB/s" << std::setw(11) << "Mtok/s" << std::setw(10) << "scaling"
+            << std::setw(12) << "tokens" << "\n";
+    }
+
+    // scaling : 1 스레드 대비 속도 향상 / 스레드 수 (1.0 이 이상적)
+    void PrintRow(const char* corpus, const char* kernel, int threads, int64_t bytes, const Result& r, double base_ms,
+        int64_t expected_tokens)
+    {
+        std::cout << std::left << std::setw(10) << corpus << std::setw(8) << kernel << std::right << std::setw(8) << threads;
+        if (r.tokens < 0) {
+            std::cout << "  failed\n";
+            return;
+        }
+        const double seconds = r.best_ms / 1000.0;
+        std::cout << std::fixed << std::setprecision(2)
+            << std::setw(11) << r.best_ms << std::setw(11) << r.median_ms
+            << std::setw(9) << bytes / seconds / 1e9
+            << std::setw(11) << r.tokens / seconds / 1e6
+            << std::setw(10) << (base_ms > 0 ? base_ms / r.best_ms / threads : 1.0)
+            << std::setw(12) << r.tokens;
+        if (expected_tokens >= 0 && r.tokens != expected_tokens) std::cout << "  MISMATCH(" << expected_tokens << ")";
+        std::cout << "\n";
+    }
+
+    std::vector<int> ThreadCounts(int max_threads) {
+        std::vector<int> counts;
+        for (int n = 1; n < max_threads; n *= 2) counts.push_back(n);
+        counts.push_back(max_threads);
+        return counts;
+    }
+
+    int run(int argc, char* argv[]) {
+        const int64_t size = (argc > 1 ? std::max(1, atoi(argv[1])) : 64) * (int64_t(1) << 20);
+        const int repeat = argc > 2 ? std::max(1, atoi(argv[2])) : 5;
+        int max_threads = argc > 3 ? atoi(argv[3]) : 0;
+        if (max_threads <= 0) max_threads = static_cast<int>(std::thread::hardware_concurrency());
+        if (max_threads <= 0) max_threads = 1;
+
+        const std::vector<Corpus> corpora = {
+            { "geometry", MakeGeometry, false },
+            { "logs", MakeLogs, false },
+            { "nested", MakeNested, false },
+            { "escapes", MakeEscapes, false },
+            { "ndjson", MakeNdjson, true },
+        };
+        const struct { const char* name; clau::SimdLevel level; } kernels[] = {
+            { "avx512", clau::SimdLevel::AVX512 },  // ScanWithAvx512
+            { "avx2", clau::SimdLevel::AVX2 },      // ScanWithSimdJsonStyle
+            { "sse42", clau::SimdLevel::SSE42 },    // _Scanning_SIMD
+            { "scalar", clau::SimdLevel::SCALAR },  // _Scanning
+        };
+
+        std::cout << "cpu " << clau::CpuFeatures::Name(clau::CpuFeatures::Best())
+            << ", corpus " << (size >> 20) << "MiB, repeat " << repeat << ", threads up to " << max_threads << "\n\n";
+        PrintHeader();
+
+        clau::InFileReserver reserver;
+        for (const auto& corpus : corpora) {
+            bool selected = argc <= 4;
+            for (int k = 4; k < argc; ++k) selected |= strcmp(argv[k], corpus.name) == 0;
+            if (!selected) continue;
+
+            const std::string text = corpus.make(size);
+            const int64_t bytes = static_cast<int64_t>(text.size());
+            reserver.SetJsonLines(corpus.json_lines);
+
+            // 단일 스레드 바이트 단위 스캐너 (Scanning) : 비교 기준
+            const Result serial = Measure(repeat, [&] {
+                clau::Token* tokens = nullptr;
+                int64_t token_len = 0;
+                clau::InFileReserver::ScanSerial(text.c_str(), bytes, tokens, token_len);
+                const bool ok = tokens != nullptr;
+                free(tokens);
+                return ok ? token_len : int64_t(-1);
+                });
+            PrintRow(corpus.name, "serial", 1, bytes, serial, 0, -1);
+
+            int64_t expected = -1;  // 처음 성공한 커널의 토큰 수 (커널끼리는 같아야 한다)
+            for (const auto& kernel : kernels) {
+                if (kernel.level > clau::CpuFeatures::Best()) continue;
+                reserver.SetSimdLevel(kernel.level);
+
+                double base_ms = 0;
+                for (int threads : ThreadCounts(max_threads)) {
+                    const Result r = Measure(repeat, [&] {
+                        const clau::Token* tokens = nullptr;
+                        int64_t token_len = 0;
+                        return reserver.ScanBuffer(text.data(), bytes, threads, tokens, token_len) ? token_len : int64_t(-1);
+                        });
+                    if (threads == 1) base_ms = r.best_ms;
+                    if (expected < 0) expected = r.tokens;
+                    PrintRow(corpus.name, kernel.name, threads, bytes, r, base_ms, expected);
+                }
+            }
+            std::cout << "\n";
+        }
+        return 0;
+    }
+
+}
+
+int main(int argc, char* argv[])
+{
+	return clau_bench::run(argc, argv);
+}
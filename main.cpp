@@ -21,13 +21,25 @@
 #include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <map>
+#include <memory>
+#include <cstring>
+#include <climits>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <share.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 namespace clau_test {
 
-    inline bool isspace(int x) {
-        return x == ' ' || x == '\t' || x == '\r' || x == '\n';
-    }
-
     // ----- Generator (토큰/Chunk 생산자) -----
     template <typename T>
     struct Generator {
@@ -49,149 +61,422 @@ namespace clau_test {
 
         handle_type coro;
         Generator(handle_type h) : coro(h) {}
+        Generator(Generator&& other) noexcept : coro(std::exchange(other.coro, {})) {}
+        Generator(const Generator&) = delete;
+        Generator& operator=(const Generator&) = delete;
         ~Generator() { if (coro) coro.destroy(); }
 
+        // 값은 복사하지 않고 꺼내 넘긴다
         std::optional<T> next() {
             if (!coro.done()) coro.resume();
-            return coro.done() ? std::nullopt : coro.promise().current_value;
+            if (coro.done()) return std::nullopt;
+            return std::move(coro.promise().current_value);
         }
     };
 
-    struct Wrap {
-        char buf[4096];
-        uint64_t len;
+    // ----- 청크 (입력 버퍼 + 그 버퍼의 토큰) -----
+    //  읽기 → 스캔 → 소비 단계 사이를 포인터로만 넘기고, 다 쓰면 풀로 돌아가 재사용된다.
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        int64_t capacity = 0;
+        int64_t length = 0;   // 스캔할 바이트 수 (마지막 분할 가능 위치까지)
+        int64_t offset = 0;   // 스트림 안에서 data[0] 의 위치
+        int64_t seq = 0;
+
+        bool guess = false;       // 추측한 시작 상태 (문자열 안인가)
+        bool end_state = false;   // 그 시작 상태로 스캔한 끝 상태
+        clau::TokenArena<clau::Token> tokens;  // data 안의 오프셋
+        int64_t token_len = 0;
+
+        ~Chunk() { tokens.Release(); }
+
+        // 앞쪽 used 바이트는 유지하고 버퍼를 size 이상으로 늘린다
+        void Grow(int64_t size, int64_t used) {
+            if (size <= capacity) return;
+            std::unique_ptr<char[]> bigger(new char[size]);
+            memcpy(bigger.get(), data.get(), used);
+            data = std::move(bigger);
+            capacity = size;
+        }
     };
 
-    Generator<Wrap> Read(const char* fileName) {
-        std::ifstream file;
-        uint64_t len = 0;
-        file.open(fileName, std::ios::binary);
-        if (!file) {
-            co_return; // 파일 열기 실패
+    // 고정 개수 청크 풀. 모두 사용 중이면 Acquire 가 기다린다 (→ 읽기 단계 backpressure)
+    class ChunkPool {
+        std::vector<std::unique_ptr<Chunk>> all;
+        std::vector<Chunk*> free_list;
+        std::mutex m;
+        std::condition_variable cv;
+    public:
+        ChunkPool(int count, int64_t size) {
+            for (int i = 0; i < count; ++i) {
+                auto chunk = std::make_unique<Chunk>();
+                chunk->data.reset(new char[size]);
+                chunk->capacity = size;
+                free_list.push_back(chunk.get());
+                all.push_back(std::move(chunk));
+            }
         }
 
-        while (true) {
-            Wrap w{};
-            file.read(w.buf, sizeof(w.buf));
-            std::streamsize n = file.gcount(); // 실제 읽은 바이트 수
-            if (n <= 0) {
-                break; // EOF
+        size_t Size() const { return all.size(); }
+
+        Chunk* Acquire() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return !free_list.empty(); });
+            Chunk* chunk = free_list.back();
+            free_list.pop_back();
+            return chunk;
+        }
+
+        void Release(Chunk* chunk) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                free_list.push_back(chunk);
             }
-            w.len = static_cast<uint64_t>(n);
-            co_yield w;
+            cv.notify_all();
         }
-    }
 
-    // ----- 토큰 타입 -----
-    struct Token {
-        int x;
+        bool Available() {
+            std::lock_guard<std::mutex> lock(m);
+            return !free_list.empty();
+        }
+
+        void WaitAvailable() {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return !free_list.empty(); });
+        }
     };
 
-    // ----- 개선된 토크나이저 (바로 토큰 묶음 생성) -----
-    Generator<std::vector<Token>> tokenize_chunks(Generator<Wrap>& input) {
-        std::vector<Token> current_chunk;
-        current_chunk.reserve(10240);
-        std::string current_token;
-        int token_count = 0;
-
-        while (auto x = input.next()) {
-            for (char c : std::string_view(x->buf, x->len)) {
-                if (c == '{' || c == '}' || c == '[' || c == ']' ||
-                    c == ':' || c == ',') {
-
-                    // 현재 토큰이 있다면 먼저 추가
-                    if (!current_token.empty()) {
-                        current_chunk.push_back(Token{ current_token[0] });
-                        current_token.clear();
-                        token_count++;
-                    }
+    // ----- 크기 제한 큐 -----
+    template <class T>
+    class BoundedQueue {
+        std::queue<T> q;
+        size_t limit;
+        bool closed = false;
+        std::mutex m;
+        std::condition_variable not_full, not_empty;
+    public:
+        explicit BoundedQueue(size_t limit) : limit(limit) {}
+
+        void Push(T value) {
+            {
+                std::unique_lock<std::mutex> lock(m);
+                not_full.wait(lock, [&] { return q.size() < limit || closed; });
+                q.push(std::move(value));
+            }
+            not_empty.notify_one();
+        }
 
-                    // 구분자 토큰 추가
-                    current_chunk.push_back(Token{ c });
-                    token_count++;
-
-                    // 콤마를 만나고 충분한 토큰이 쌓였다면 청크 생성
-                    if (c == ',' && token_count > 10240) {
-                        if (!current_chunk.empty()) {
-                            co_yield current_chunk;
-                            current_chunk.clear();
-                            current_chunk.reserve(10240);
-                            token_count = 0;
-                        }
-                    }
-                }
-                else if (!isspace(c)) {
-                    if (current_token.empty()) {
-                        current_token.push_back(c);
-                    }
-                }
+        // 닫혔고 비었으면 nullopt
+        std::optional<T> Pop() {
+            std::optional<T> value;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                not_empty.wait(lock, [&] { return !q.empty() || closed; });
+                if (q.empty()) return std::nullopt;
+                value = std::move(q.front());
+                q.pop();
             }
+            not_full.notify_one();
+            return value;
         }
 
-        // 마지막 토큰 처리
-        if (!current_token.empty()) {
-            current_chunk.push_back(Token{ current_token[0] });
+        void Close() {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                closed = true;
+            }
+            not_full.notify_all();
+            not_empty.notify_all();
         }
+    };
 
-        // 마지막 청크 출력
-        if (!current_chunk.empty()) {
-            co_yield current_chunk;
+    // ----- 입력 : 파일, 표준 입력("-"), Unix 소켓("unix:/path") -----
+    int OpenSource(const char* name) {
+        if (strcmp(name, "-") == 0) {
+#ifdef _WIN32
+            _setmode(0, _O_BINARY);
+#endif
+            return 0;
         }
+#ifdef _WIN32
+        if (strncmp(name, "unix:", 5) == 0) return -1;
+        int fd = -1;
+        _sopen_s(&fd, name, _O_RDONLY | _O_BINARY, _SH_DENYNO, 0);
+        return fd;
+#else
+        if (strncmp(name, "unix:", 5) == 0) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (strlen(name + 5) >= sizeof(addr.sun_path)) return -1;
+            strcpy(addr.sun_path, name + 5);
+
+            int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0) return -1;
+            if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+        return open(name, O_RDONLY);
+#endif
     }
 
-    // ----- 비동기 파싱 워커 -----
-    std::string parse_subtree(const std::vector<Token>& tokens) {
-        std::string result;
-        return result;
+    void CloseSource(int fd) {
+        if (fd <= 0) return;
+#ifdef _WIN32
+        _close(fd);
+#else
+        close(fd);
+#endif
     }
 
-    // ----- Merger (비동기 태스크 실행 + 결과 합치기) -----
-    void merger(Generator<std::vector<Token>>& chunks) {
-        std::vector<std::future<std::string>> tasks;
+    // 0 : EOF, < 0 : 오류
+    int64_t ReadSome(int fd, char* dst, int64_t size) {
+#ifdef _WIN32
+        return _read(fd, dst, static_cast<unsigned int>(std::min<int64_t>(size, INT_MAX)));
+#else
+        while (true) {
+            const ssize_t n = read(fd, dst, static_cast<size_t>(size));
+            if (n < 0 && errno == EINTR) continue;
+            return n;
+        }
+#endif
+    }
 
-        int count = 0;
-        while (auto chunk = chunks.next()) {
-            //tasks.push_back(std::async(std::launch::async, [chunk]() {
-             //   return parse_subtree(*chunk);
-              //  }));
-            ++count;
+    // ----- 스트림 오류 -----
+    // 단계는 오류를 만나면 여기에 적고 더 내보내지 않는다. run() 이 모두 정리한 뒤 알린다.
+    struct StreamError {
+        std::string what;      // 비어 있으면 오류 없음
+        int64_t offset = -1;   // 스트림 안의 위치 (모르면 -1)
+
+        explicit operator bool() const { return !what.empty(); }
+        void Set(std::string message, int64_t at) {
+            if (*this) return;  // 처음 것만
+            what = std::move(message);
+            offset = at;
         }
+    };
+
+    // ----- 읽기 : 청크를 채우고 마지막 분할 가능 위치에서 잘라 넘긴다 -----
+    //  잘린 뒤쪽(다음 토큰의 앞부분)은 다음 청크 앞에 복사한다.
+    //  파이프/소켓이 잠시 멈추면 min_fill 이상 모인 만큼만 먼저 넘긴다.
+    //  분할 가능 위치가 하나도 없으면 (아주 긴 문자열) 그 청크의 버퍼를 두 배로 늘린다.
+    //  넘길 뒤쪽이 다음 청크보다 크면 그 청크도 늘린다.
+    //  읽기 오류(끊긴 소켓 등)는 EOF 가 아니다 : error 에 적고 그 청크는 넘기지 않는다.
+    Generator<Chunk*> Read(int fd, ChunkPool& pool, int64_t min_fill, StreamError& error) {
+        std::string carry;
+        int64_t offset = 0;
+        bool eof = false;
+
+        while (!eof) {
+            Chunk* chunk = pool.Acquire();
+            chunk->Grow(static_cast<int64_t>(carry.size()) * 2, 0);
+            memcpy(chunk->data.get(), carry.data(), carry.size());
+            int64_t have = static_cast<int64_t>(carry.size());
+            int64_t cut = 0;
+
+            while (true) {
+                while (have < chunk->capacity) {
+                    const int64_t n = ReadSome(fd, chunk->data.get() + have, chunk->capacity - have);
+                    if (n < 0) {
+                        error.Set(std::string("read failed : ") + strerror(errno), offset + have);
+                        pool.Release(chunk);
+                        co_return;
+                    }
+                    if (n == 0) { eof = true; break; }
+                    have += n;
+                    if (have >= min_fill && n < chunk->capacity - (have - n)) break;
+                }
+                if (eof) { cut = have; break; }
+
+                cut = clau::InFileReserver::LastSplitPoint(chunk->data.get(), have);
+                if (cut > 0) break;
+                if (have < chunk->capacity) continue;
+                chunk->Grow(chunk->capacity * 2, have);
+            }
+
+            carry.assign(chunk->data.get() + cut, have - cut);
+            chunk->length = cut;
+            chunk->offset = offset;
+            offset += cut;
 
-        // 결과 합성 (여기서는 단순 출력)
-        std::cout << "=== AST Results ===\n";
-        for (auto& t : tasks) {
-            t.get();
+            if (cut == 0) { pool.Release(chunk); continue; }
+            co_yield chunk;
         }
+    }
+
+    // ----- 병렬 토크나이저 -----
+    //  consumers 개 스레드가 작업 큐에서 청크를 꺼내 추측한 시작 상태로 SIMD 스캔하고,
+    //  여기서 순서대로 다시 맞추며 문자열 상태를 이어 붙인다. 추측이 틀린 청크만 다시 스캔한다.
+    //  나오는 청크는 스트림 순서이고, 토큰은 clau::InFileReserver 로 한 번에 스캔한 것과 같다.
+    // 아레나 확보 실패 / 잘못된 UTF-8 이면 error 에 적고 멈춘다 (워커는 Joiner 가 정리).
+    Generator<Chunk*> tokenize_chunks(Generator<Chunk*>& input, ChunkPool& pool, int consumers, StreamError& error) {
+        const clau::SimdLevel level = clau::CpuFeatures::Best();
+        BoundedQueue<Chunk*> work(pool.Size());
+        BoundedQueue<Chunk*> done(pool.Size());  // 풀 크기 이상 쌓이지 않으므로 Push 가 막히지 않는다
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < consumers; ++i) {
+            workers.emplace_back([&] {
+                while (auto next = work.Pop()) {
+                    Chunk* chunk = *next;
+                    chunk->guess = chunk->seq > 0 && clau::InFileReserver::GuessChunkState(chunk->data.get(), chunk->length);
+                    chunk->end_state = clau::InFileReserver::ScanChunk(chunk->data.get(), chunk->length, chunk->guess,
+                        chunk->tokens, chunk->token_len, level);
+                    done.Push(chunk);
+                }
+            });
+        }
+
+        // 소비자가 중간에 그만둬 코루틴이 파괴되어도 워커는 정리한다
+        struct Joiner {
+            BoundedQueue<Chunk*>& work;
+            std::vector<std::thread>& workers;
+            ~Joiner() {
+                work.Close();
+                for (auto& t : workers) t.join();
+            }
+        } joiner{ work, workers };
+
+        std::map<int64_t, Chunk*> pending;  // 먼저 끝난 뒤쪽 청크
+        int64_t pushed = 0, next_seq = 0;
+        bool in_string = false;
+        bool eof = false;
+
+        while (true) {
+            // 읽기 단계는 풀에 남은 청크가 있을 때만 부른다 (모두 아래 단계에 있으면 여기서 막힌다)
+            if (!eof && pool.Available()) {
+                auto next = input.next();
+                if (!next) { eof = true; continue; }
+                (*next)->seq = pushed++;
+                work.Push(*next);
+                continue;
+            }
+            if (next_seq == pushed) {
+                if (eof) break;
+                pool.WaitAvailable();
+                continue;
+            }
+
+            Chunk* chunk = *done.Pop();
+            pending.emplace(chunk->seq, chunk);
+
+            for (auto it = pending.begin(); it != pending.end() && it->first == next_seq; it = pending.erase(it)) {
+                chunk = it->second;
+                if (chunk->guess != in_string) {
+                    chunk->guess = in_string;
+                    chunk->end_state = clau::InFileReserver::ScanChunk(chunk->data.get(), chunk->length, in_string,
+                        chunk->tokens, chunk->token_len, level);
+                }
+                if (chunk->tokens.failed) {
+                    error.Set("token arena alloc failed", chunk->offset);
+                    co_return;
+                }
+                if (chunk->tokens.bad_utf8) {
+                    error.Set("invalid UTF-8",
+                        chunk->offset + clau::Utf8Validator::FirstInvalid(chunk->data.get(), chunk->length));
+                    co_return;
+                }
+                in_string = chunk->end_state;
+                ++next_seq;
+                co_yield chunk;
+            }
+        }
+    }
+
+    // ----- Merger (토큰 묶음 소비 + 풀로 반환) -----
+    struct Summary {
+        int64_t bytes = 0;
+        int64_t tokens = 0;
+        int64_t chunks = 0;
+        uint64_t checksum = 0;  // 스트림 전체 기준 토큰 오프셋 합
+    };
 
-        std::cout << count << "\n";
+    Summary merger(Generator<Chunk*>& chunks, ChunkPool& pool) {
+        Summary summary;
+        while (auto next = chunks.next()) {
+            Chunk* chunk = *next;
+            for (int64_t i = 0; i < chunk->token_len; ++i)
+                summary.checksum += static_cast<uint64_t>(chunk->offset) + chunk->tokens.data[i];
+            summary.tokens += chunk->token_len;
+            summary.bytes += chunk->length;
+            ++summary.chunks;
+            pool.Release(chunk);
+        }
+        return summary;
     }
 
-    void run() {
-        int a = clock();
-        auto read_gen = Read("citylots.json");
-        auto chunk_gen = tokenize_chunks(read_gen);  // dispatcher 단계 제거
-        merger(chunk_gen);
+    // source : 파일 경로, "-" (표준 입력), "unix:/path"
+    int run(const char* source, int consumers = 0, int64_t chunk_size = int64_t(1) << 20) {
+        if (consumers <= 0) consumers = std::max(1u, std::thread::hardware_concurrency());
+
+        const int fd = OpenSource(source);
+        if (fd < 0) {
+            std::cout << "open failed " << source << "\n";
+            return 1;
+        }
+
+        auto a = std::chrono::steady_clock::now();
+        Summary summary;
+        StreamError error;
+        {
+            ChunkPool pool(consumers * 2 + 2, chunk_size);
+            auto read_gen = Read(fd, pool, chunk_size / 16, error);
+            auto chunk_gen = tokenize_chunks(read_gen, pool, consumers, error);
+            summary = merger(chunk_gen, pool);
+        }
+        auto b = std::chrono::steady_clock::now();
+        CloseSource(fd);
+
+        if (error) {
+            std::cout << "stream failed " << source << " : " << error.what;
+            if (error.offset >= 0) std::cout << " at " << error.offset;
+            std::cout << "\n";
+            return 1;
+        }
 
-        int b = clock();
-        std::cout << b - a << "ms\n";
+        std::cout << "stream bytes " << summary.bytes << " tokens " << summary.tokens
+            << " chunks " << summary.chunks << " checksum " << summary.checksum << "\n";
+        std::cout << std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count() << "ms\n";
+        return 0;
     }
 
 }
 
 int main(int argc, char* argv[])
 {
-    //clau_test::run();
-
-    //return 0;
+	// --stream <파일 | - | unix:/path> [소비 스레드 수] : 파이프/소켓 스트리밍 토크나이저
+	if (argc > 2 && strcmp(argv[1], "--stream") == 0) {
+		return clau_test::run(argv[2], argc > 3 ? atoi(argv[3]) : 0);
+	}
 
 	clau::LoadData test;
+	test.SetStats(true);  // 단계별 시간 / 워커별 몫 / 할당 크기 (기본은 꺼져 있어 아무것도 출력하지 않는다)
 
-	for (int i = 0; i < 10; ++i) {
-		int a = clock();
-		test.LoadDataFromFile(argv[1], 0, 0, true); // 1, 0
-		int b = clock();
+	// argv[2] : scalar | sse42 | avx2 | avx512 (생략 시 CPUID 로 자동 선택)
+	if (argc > 2) {
+		clau::SimdLevel level;
+		if (clau::CpuFeatures::Parse(argv[2], level)) test.SetSimdLevel(level);
+	}
+	std::cout << "simd " << clau::CpuFeatures::Name(test.GetSimdLevel()) << "\n";
 
-		std::cout << "test end " << b - a << "ms\n";
+	// 벽시계 시간 : clock() 은 모든 스레드의 CPU 시간 합이라 스레드를 늘릴수록 커 보인다 (커널별 비교는 bench.cpp)
+	for (int i = 0; i < 10; ++i) {
+		auto a = std::chrono::steady_clock::now();
+		const bool ok = test.LoadDataFromFile(argv[1], 0, 0, true); // 1, 0
+		auto b = std::chrono::steady_clock::now();
+
+		// 라이브러리는 출력하지 않으므로 실패 위치는 여기서 알린다 (-1 : 위치 없음, 예: 파일을 열 수 없음)
+		if (!ok) {
+			std::cout << "load failed " << argv[1];
+			if (test.GetUtf8Error() >= 0) std::cout << " : invalid UTF-8 at " << test.GetUtf8Error();
+			else if (test.GetSyntaxError() >= 0) std::cout << " : invalid JSON at " << test.GetSyntaxError();
+			std::cout << "\n";
+			return 1;
+		}
+		test.GetStats().Print(std::cout);
+		std::cout << "test end " << std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count() << "ms\n";
 	}
 	return 0;
 }
@@ -16,8 +16,15 @@
 #include <thread>
 #include <cstdlib>      // calloc, free
 #include <new>          // std::nothrow
-#include <ctime>        // clock()
 #include <string_view>  // std::string_view
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <charconv>     // std::from_chars
+#include <tuple>
 
 #include <immintrin.h>  // SSE4.2 / AVX2
 
@@ -66,773 +73,5123 @@ namespace clau_compat {
 #endif
 #endif
 
+// ── 5. 이식 가능한 64비트 비트 조작 ─────────────────────────────────
+//  타깃 속성이 없는 공용 코드에서 사용. BMI 타깃 함수에 인라인되면 tzcnt/blsr 로 컴파일된다.
+namespace clau_compat {
+#ifdef _MSC_VER
+    __forceinline int ctz64(uint64_t x) { unsigned long idx; _BitScanForward64(&idx, x); return static_cast<int>(idx); }
+    __forceinline int clz64(uint64_t x) { unsigned long idx; _BitScanReverse64(&idx, x); return 63 - static_cast<int>(idx); }
+    __forceinline int popcount64(uint64_t x) { return static_cast<int>(__popcnt64(x)); }
+    // 64 x 64 → 128 비트 곱 (상위 반환, 하위는 lo)
+    __forceinline uint64_t mul128(uint64_t a, uint64_t b, uint64_t& lo) { return lo = _umul128(a, b, &a), a; }
+#else
+    __forceinline int ctz64(uint64_t x) { return __builtin_ctzll(x); }
+    __forceinline int clz64(uint64_t x) { return __builtin_clzll(x); }
+    __forceinline int popcount64(uint64_t x) { return __builtin_popcountll(x); }
+    __forceinline uint64_t mul128(uint64_t a, uint64_t b, uint64_t& lo) {
+        const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+        lo = static_cast<uint64_t>(r);
+        return static_cast<uint64_t>(r >> 64);
+    }
+#endif
+}
+
+// ── 6. 함수 단위 타깃 ISA ─────────────────────────────────────────
+//  전체를 -mavx2 로 빌드하지 않고도 커널별로 ISA 를 지정 → 런타임 디스패치.
+//  MSVC 는 /arch 없이도 모든 인트린식을 허용하므로 비워둔다.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CLAU_TARGET_SSE42
+#define CLAU_TARGET_AVX2
+#define CLAU_TARGET_AVX512
+#else
+#define CLAU_TARGET_SSE42  __attribute__((target("sse4.2,popcnt")))
+#define CLAU_TARGET_AVX2   __attribute__((target("avx2,bmi,bmi2,pclmul,popcnt")))
+#define CLAU_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,bmi,bmi2,pclmul,popcnt")))
+#endif
+
+// ── 7. CPUID / XGETBV ────────────────────────────────────────────
+#ifdef _MSC_VER
+namespace clau_compat {
+    inline void cpuid(uint32_t leaf, uint32_t sub, uint32_t out[4]) {
+        int r[4];
+        __cpuidex(r, static_cast<int>(leaf), static_cast<int>(sub));
+        for (int i = 0; i < 4; ++i) out[i] = static_cast<uint32_t>(r[i]);
+    }
+    inline uint64_t xgetbv0() { return _xgetbv(0); }
+}
+#else
+#include <cpuid.h>
+namespace clau_compat {
+    inline void cpuid(uint32_t leaf, uint32_t sub, uint32_t out[4]) {
+        out[0] = out[1] = out[2] = out[3] = 0;
+        __get_cpuid_count(leaf, sub, &out[0], &out[1], &out[2], &out[3]);
+    }
+    inline uint64_t xgetbv0() {
+        uint32_t lo, hi;
+        __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<uint64_t>(hi) << 32) | lo;
+    }
+}
+#endif
+
+// ── 8. 스레드 코어 고정 ──────────────────────────────────────────
+//  allowed_cpus : 프로세스가 실행될 수 있는 CPU 목록 (컨테이너 cpuset 존중)
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+namespace clau_compat {
+    inline std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        DWORD_PTR proc = 0, sys = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &proc, &sys)) {
+            for (int i = 0; i < static_cast<int>(sizeof(DWORD_PTR) * 8); ++i)
+                if (proc & (DWORD_PTR(1) << i)) cpus.push_back(i);
+        }
+        return cpus;
+    }
+    inline bool pin_current_thread(int cpu) {
+        return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+    }
+}
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+namespace clau_compat {
+    inline std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+                if (CPU_ISSET(i, &set)) cpus.push_back(i);
+        }
+        return cpus;
+    }
+    inline bool pin_current_thread(int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+}
+#else
+namespace clau_compat {
+    inline std::vector<int> allowed_cpus() { return {}; }
+    inline bool pin_current_thread(int) { return false; }
+}
+#endif
+
+// ── 9. 최대 상주 메모리 (peak RSS) ───────────────────────────────────
+//  프로세스 시작 이후 최대 RSS (바이트). 알 수 없으면 0
+#ifdef _WIN32
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+namespace clau_compat {
+    inline int64_t peak_rss() {
+        PROCESS_MEMORY_COUNTERS pmc;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return 0;
+        return static_cast<int64_t>(pmc.PeakWorkingSetSize);
+    }
+}
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+namespace clau_compat {
+    inline int64_t peak_rss() {
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#ifdef __APPLE__
+        return static_cast<int64_t>(ru.ru_maxrss);          // 바이트
+#else
+        return static_cast<int64_t>(ru.ru_maxrss) * 1024;   // KiB
+#endif
+    }
+}
+#else
+namespace clau_compat {
+    inline int64_t peak_rss() { return 0; }
+}
+#endif
+
+// ── 10. 읽기 전용 파일 매핑 ───────────────────────────────────────────
+//  populate   : 매핑할 때 페이지 테이블을 미리 채운다 (MAP_POPULATE / PrefetchVirtualMemory)
+//  sequential : 순차 접근 힌트 (MADV_SEQUENTIAL / FILE_FLAG_SEQUENTIAL_SCAN)
+//  huge_pages : transparent huge page 힌트 (MADV_HUGEPAGE). 파일 매핑은 커널 설정에 따라 무시될 수 있다
+//  빈 파일은 data() == nullptr, size() == 0 으로 성공한다.
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+namespace clau_compat {
+    class MappedFile {
+    private:
+        const char* ptr = nullptr;
+        int64_t len = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { Close(); }
+
+        const char* data() const { return ptr; }
+        int64_t size() const { return len; }
+
+#ifdef _WIN32
+        bool Open(const char* path, bool populate, bool sequential, bool /*huge_pages*/) {
+            Close();
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return false;
+
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file, &file_size)) { Close(); return false; }
+            if (file_size.QuadPart == 0) return true;
+
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) { Close(); return false; }
+            ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (!ptr) { Close(); return false; }
+            len = file_size.QuadPart;
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+            if (populate) {
+                WIN32_MEMORY_RANGE_ENTRY range{ const_cast<char*>(ptr), static_cast<SIZE_T>(len) };
+                PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+            }
+#else
+            (void)populate;
+#endif
+            return true;
+        }
+
+        void Close() {
+            if (ptr) UnmapViewOfFile(ptr);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            ptr = nullptr; len = 0; mapping = nullptr; file = INVALID_HANDLE_VALUE;
+        }
+#else
+        bool Open(const char* path, bool populate, bool sequential, bool huge_pages) {
+            Close();
+            const int fd = open(path, O_RDONLY);
+            if (fd < 0) return false;
+
+            struct stat st;
+            if (fstat(fd, &st) != 0) { close(fd); return false; }
+            if (st.st_size == 0) { close(fd); return true; }
+
+            int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            if (populate) flags |= MAP_POPULATE;
+#else
+            (void)populate;
+#endif
+            void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, flags, fd, 0);
+            close(fd);  // 매핑은 fd 를 닫아도 유지된다
+            if (p == MAP_FAILED) return false;
+
+            if (sequential) madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            if (huge_pages) madvise(p, static_cast<size_t>(st.st_size), MADV_HUGEPAGE);
+#else
+            (void)huge_pages;
+#endif
+            ptr = static_cast<const char*>(p);
+            len = static_cast<int64_t>(st.st_size);
+            return true;
+        }
+
+        void Close() {
+            if (ptr) munmap(const_cast<char*>(ptr), static_cast<size_t>(len));
+            ptr = nullptr; len = 0;
+        }
+#endif
+    };
+}
+
+// ── 11. 위치 지정 읽기 (pread) ────────────────────────────────────────
+//  파일 위치를 공유하지 않으므로 여러 스레드가 한 핸들로 동시에 읽을 수 있다.
+//  Identify : 같은 경로의 파일이 바뀌었는지 볼 때 쓴다. 다른 파일로 바뀌면 (device, file) 이 달라진다.
+//             mtime 은 플랫폼 단위 그대로 (POSIX ns, Windows 100ns) 라 같은 플랫폼 안에서만 비교한다.
+namespace clau_compat {
+    struct FileIdentity {
+        uint64_t device = 0;
+        uint64_t file = 0;
+        int64_t size = -1;
+        int64_t mtime = 0;
+    };
+
+    class ReadOnlyFile {
+    private:
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+#else
+        int fd = -1;
+#endif
+
+    public:
+        ReadOnlyFile() = default;
+        ReadOnlyFile(const ReadOnlyFile&) = delete;
+        ReadOnlyFile& operator=(const ReadOnlyFile&) = delete;
+        ~ReadOnlyFile() { Close(); }
+
+#ifdef _WIN32
+        bool Open(const char* path) {
+            Close();
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                FILE_FLAG_OVERLAPPED | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            return file != INVALID_HANDLE_VALUE;
+        }
+
+        void Close() {
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+        }
+
+        int64_t Size() const {
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file, &file_size)) return -1;
+            return file_size.QuadPart;
+        }
+
+        bool Identify(FileIdentity& id) const {
+            BY_HANDLE_FILE_INFORMATION info;
+            if (!GetFileInformationByHandle(file, &info)) return false;
+            id.device = info.dwVolumeSerialNumber;
+            id.file = (uint64_t(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+            id.size = (int64_t(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+            id.mtime = (int64_t(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+            return true;
+        }
+
+        // offset 부터 size 바이트를 모두 읽는다
+        bool ReadAt(void* dst, int64_t size, int64_t offset) const {
+            HANDLE done = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+            if (!done) return false;
+            bool ok = true;
+            while (ok && size > 0) {
+                OVERLAPPED ov = {};
+                ov.Offset = static_cast<DWORD>(offset);
+                ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+                ov.hEvent = done;
+                const DWORD want = static_cast<DWORD>(std::min<int64_t>(size, int64_t(1) << 30));
+                DWORD got = 0;
+                if (!ReadFile(file, dst, want, nullptr, &ov) && GetLastError() != ERROR_IO_PENDING) ok = false;
+                else if (!GetOverlappedResult(file, &ov, &got, TRUE) || got == 0) ok = false;
+                dst = static_cast<char*>(dst) + got;
+                size -= got;
+                offset += got;
+            }
+            CloseHandle(done);
+            return ok;
+        }
+#else
+        bool Open(const char* path) {
+            Close();
+            fd = open(path, O_RDONLY);
+            return fd >= 0;
+        }
+
+        void Close() {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+
+        int64_t Size() const {
+            struct stat st;
+            if (fstat(fd, &st) != 0) return -1;
+            return static_cast<int64_t>(st.st_size);
+        }
+
+        bool Identify(FileIdentity& id) const {
+            struct stat st;
+            if (fstat(fd, &st) != 0) return false;
+            id.device = static_cast<uint64_t>(st.st_dev);
+            id.file = static_cast<uint64_t>(st.st_ino);
+            id.size = static_cast<int64_t>(st.st_size);
+#ifdef __APPLE__
+            id.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+            id.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+            return true;
+        }
+
+        // offset 부터 size 바이트를 모두 읽는다 (짧은 읽기, EINTR 은 이어서 읽음)
+        bool ReadAt(void* dst, int64_t size, int64_t offset) const {
+            while (size > 0) {
+                const ssize_t got = pread(fd, dst, static_cast<size_t>(std::min<int64_t>(size, int64_t(1) << 30)),
+                    static_cast<off_t>(offset));
+                if (got < 0 && errno == EINTR) continue;
+                if (got <= 0) return false;
+                dst = static_cast<char*>(dst) + got;
+                size -= got;
+                offset += got;
+            }
+            return true;
+        }
+#endif
+    };
+}
+
+// ── 12. 하드웨어 카운터 (perf_event_open) ───────────────────────────
+//  호출한 스레드의 cycles / instructions / cache-misses / branch-misses (사용자 모드만, group 으로 함께 센다).
+//  권한(perf_event_paranoid)이나 가상화 때문에 열 수 없거나 Linux 가 아니면 Open / Read 가 false.
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+namespace clau_compat {
+    class PerfCounters {
+    public:
+        static constexpr int COUNT = 4;
+
+        PerfCounters() = default;
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+        ~PerfCounters() { Close(); }
+
+        bool Open() {
+            Close();
+            static const uint64_t config[COUNT] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+            for (int i = 0; i < COUNT; ++i) {
+                perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = config[i];
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                fd[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fd[0], 0));
+                if (fd[i] < 0) { Close(); return false; }
+            }
+            return true;
+        }
+
+        void Close() {
+            for (int& f : fd) {
+                if (f >= 0) close(f);
+                f = -1;
+            }
+        }
+
+        // 연 뒤로 센 값 (단조 증가. 구간 값은 두 번 읽은 차이)
+        bool Read(int64_t out[COUNT]) const {
+            if (fd[0] < 0) return false;
+            uint64_t values[1 + COUNT];
+            if (read(fd[0], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[0] != COUNT)
+                return false;
+            for (int i = 0; i < COUNT; ++i) out[i] = static_cast<int64_t>(values[1 + i]);
+            return true;
+        }
+
+    private:
+        int fd[COUNT] = { -1, -1, -1, -1 };
+    };
+}
+#else
+namespace clau_compat {
+    class PerfCounters {
+    public:
+        static constexpr int COUNT = 4;
+        bool Open() { return false; }
+        void Close() {}
+        bool Read(int64_t*) const { return false; }
+    };
+}
+#endif
+
+// ── 13. NUMA 토폴로지 / 메모리 배치 ─────────────────────────────────
+//  numa_node_of(cpu)    : CPU 가 속한 NUMA 노드 (모르면 0)
+//  current_numa_node()  : 호출 스레드가 지금 도는 CPU 의 노드 (모르면 -1)
+//  prefer_numa_node(p, size, node) : [p, p + size) 안의 온전한 페이지를 node 에 두고, 이미 다른 노드에 있는
+//                         페이지는 옮긴다 (mbind MPOL_PREFERRED + MPOL_MF_MOVE). 못 하면 false → first-touch 에 맡긴다
+//  topology_order(cpus) : 워커를 고정할 순서. 물리 코어마다 하나씩 먼저, SMT 형제는 그 뒤에 놓고,
+//                         각 단계 안에서는 노드 → 소켓 → 코어 순이라 이웃한 워커가 같은 노드에 모인다
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/mempolicy.h>
+namespace clau_compat {
+    inline int read_sysfs_int(const std::string& path, int fallback) {
+        FILE* f = fopen(path.c_str(), "r");
+        if (!f) return fallback;
+        int value = fallback;
+        if (fscanf(f, "%d", &value) != 1) value = fallback;
+        fclose(f);
+        return value;
+    }
+
+    inline int numa_node_of(int cpu) {
+        DIR* dir = opendir(("/sys/devices/system/cpu/cpu" + std::to_string(cpu)).c_str());
+        if (!dir) return 0;
+        int node = 0;
+        while (const dirent* entry = readdir(dir)) {
+            if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+                node = atoi(entry->d_name + 4);
+                break;
+            }
+        }
+        closedir(dir);
+        return node;
+    }
+
+    inline int cpu_package_of(int cpu) {
+        return read_sysfs_int("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/physical_package_id", 0);
+    }
+    inline int cpu_core_of(int cpu) {
+        return read_sysfs_int("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/core_id", cpu);
+    }
+
+    inline int current_numa_node() {
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return -1;
+        return static_cast<int>(node);
+    }
+
+    inline bool prefer_numa_node(void* p, int64_t size, int node) {
+        constexpr int bits = 8 * sizeof(unsigned long);
+        unsigned long mask[1024 / bits] = {};
+        if (node < 0 || node >= 1024 || size <= 0) return false;
+        const uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const uintptr_t first = (reinterpret_cast<uintptr_t>(p) + page - 1) & ~(page - 1);
+        const uintptr_t last = (reinterpret_cast<uintptr_t>(p) + static_cast<uintptr_t>(size)) & ~(page - 1);
+        if (last <= first) return true;
+        mask[node / bits] = 1UL << (node % bits);
+        return syscall(SYS_mbind, first, last - first, MPOL_PREFERRED, mask, sizeof(mask) * 8, MPOL_MF_MOVE) == 0;
+    }
+}
+#elif defined(_WIN32)
+namespace clau_compat {
+    inline int numa_node_of(int cpu) {
+        UCHAR node = 0;
+        return GetNumaProcessorNode(static_cast<UCHAR>(cpu), &node) ? static_cast<int>(node) : 0;
+    }
+    inline int cpu_package_of(int) { return 0; }
+    inline int cpu_core_of(int cpu) { return cpu; }
+    inline int current_numa_node() { return numa_node_of(static_cast<int>(GetCurrentProcessorNumber())); }
+    inline bool prefer_numa_node(void*, int64_t, int) { return false; }  // 할당 뒤 옮기기는 없다 : first-touch 만
+}
+#else
+namespace clau_compat {
+    inline int numa_node_of(int) { return 0; }
+    inline int cpu_package_of(int) { return 0; }
+    inline int cpu_core_of(int cpu) { return cpu; }
+    inline int current_numa_node() { return -1; }
+    inline bool prefer_numa_node(void*, int64_t, int) { return false; }
+}
+#endif
+namespace clau_compat {
+    inline std::vector<int> topology_order(const std::vector<int>& cpus) {
+        struct Place { int cpu, node, package, core, thread; };
+        std::vector<Place> places;
+        for (int cpu : cpus) places.push_back({ cpu, numa_node_of(cpu), cpu_package_of(cpu), cpu_core_of(cpu), 0 });
+
+        // thread : 같은 물리 코어 안에서 몇 번째 논리 CPU 인가 (0 이 먼저 고정된다)
+        auto by_core = [](const Place& x, const Place& y) {
+            return std::make_tuple(x.node, x.package, x.core, x.cpu) < std::make_tuple(y.node, y.package, y.core, y.cpu);
+            };
+        std::sort(places.begin(), places.end(), by_core);
+        for (size_t i = 1; i < places.size(); ++i) {
+            const Place& prev = places[i - 1];
+            if (prev.package == places[i].package && prev.core == places[i].core && prev.node == places[i].node)
+                places[i].thread = prev.thread + 1;
+        }
+        std::stable_sort(places.begin(), places.end(), [](const Place& x, const Place& y) { return x.thread < y.thread; });
+
+        std::vector<int> order;
+        for (const auto& place : places) order.push_back(place.cpu);
+        return order;
+    }
+}
+
+// windows.h 의 TRUE / FALSE 매크로는 TokenType 의 이름과 겹친다 (위 호환 코드에서만 쓴다)
+#ifdef _WIN32
+#undef TRUE
+#undef FALSE
+#endif
+
 // ════════════════════════════════════════════════════════════════
 
-namespace clau {
+namespace clau {
+
+    namespace LoadDataOption {
+        constexpr char LeftBrace = '{';
+        constexpr char RightBrace = '}';
+        constexpr char LeftBracket = '[';
+        constexpr char RightBracket = ']';
+        constexpr char Assignment = ':';
+        constexpr char Comma = ',';
+    }
+
+    // ── nibble lookup 분류 테이블 ─────────────────────────────────────
+    //  바이트 x 의 클래스 = lo[x & 0xF] & hi[x >> 4]
+    //  비트 하나가 표현하는 문자 집합은 (상위 nibble 집합 × 하위 nibble 집합)
+    //  이어야 하므로, 같은 클래스 문자를 그 조건이 깨지지 않는 한 같은 비트에 묶는다.
+    struct NibbleTable {
+        uint8_t lo[16] = {};
+        uint8_t hi[16] = {};
+        uint8_t whitespace = 0, op = 0, quote = 0, backslash = 0;
+        int     bit_count = 0;
+    };
+
+    namespace detail {
+        struct NibbleBuilder {
+            NibbleTable table;
+            bool member[8][256] = {};
+            uint8_t owner[8] = {};
+
+            // bit 집합에 ch 를 더해도 (hi 집합 × lo 집합) 형태가 유지되는가
+            constexpr bool Fits(int bit, unsigned char ch) const {
+                bool his[16] = {}, los[16] = {};
+                for (int x = 0; x < 256; ++x) {
+                    if (member[bit][x] || x == ch) { his[x >> 4] = true; los[x & 0xF] = true; }
+                }
+                for (int h = 0; h < 16; ++h) {
+                    for (int l = 0; l < 16; ++l) {
+                        int x = (h << 4) | l;
+                        if (his[h] && los[l] && !(member[bit][x] || x == ch)) return false;
+                    }
+                }
+                return true;
+            }
+
+            constexpr void Add(uint8_t& cls, int cls_id, char c) {
+                const unsigned char ch = static_cast<unsigned char>(c);
+                int bit = -1;
+                for (int b = 0; b < table.bit_count; ++b) {
+                    if (owner[b] == cls_id && Fits(b, ch)) { bit = b; break; }
+                }
+                if (bit < 0) {
+                    bit = table.bit_count++;
+                    owner[bit] = static_cast<uint8_t>(cls_id);
+                }
+                member[bit][ch] = true;
+                table.lo[ch & 0xF] |= static_cast<uint8_t>(1u << bit);
+                table.hi[ch >> 4] |= static_cast<uint8_t>(1u << bit);
+                cls |= static_cast<uint8_t>(1u << bit);
+            }
+        };
+
+        constexpr NibbleTable MakeNibbleTable() {
+            NibbleBuilder b;
+            const char ops[] = {
+                LoadDataOption::LeftBrace, LoadDataOption::RightBrace,
+                LoadDataOption::LeftBracket, LoadDataOption::RightBracket,
+                LoadDataOption::Assignment, LoadDataOption::Comma
+            };
+            for (char c : ops) b.Add(b.table.op, 1, c);
+            b.Add(b.table.quote, 2, '"');
+            b.Add(b.table.backslash, 3, '\\');
+            for (char c : { ' ', '\t', '\n', '\r' }) b.Add(b.table.whitespace, 4, c);
+            return b.table;
+        }
+
+        // 256 바이트 전부에 대해 테이블 결과가 정확한지 컴파일 타임에 확인
+        constexpr bool NibbleTableIsExact(const NibbleTable& t) {
+            for (int x = 0; x < 256; ++x) {
+                const uint8_t cls = t.lo[x & 0xF] & t.hi[x >> 4];
+                const char c = static_cast<char>(x);
+                const bool ws = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+                const bool op = c == LoadDataOption::LeftBrace || c == LoadDataOption::RightBrace ||
+                    c == LoadDataOption::LeftBracket || c == LoadDataOption::RightBracket ||
+                    c == LoadDataOption::Assignment || c == LoadDataOption::Comma;
+                if (((cls & t.whitespace) != 0) != ws) return false;
+                if (((cls & t.op) != 0) != op) return false;
+                if (((cls & t.quote) != 0) != (c == '"')) return false;
+                if (((cls & t.backslash) != 0) != (c == '\\')) return false;
+            }
+            return true;
+        }
+    }
+
+    inline constexpr NibbleTable nibble_table = detail::MakeNibbleTable();
+    static_assert(nibble_table.bit_count <= 8, "nibble table needs more than 8 class bits");
+    static_assert(detail::NibbleTableIsExact(nibble_table), "nibble table is not exact");
+
+    // 32바이트 블록의 클래스별 비트마스크
+    struct BlockMasks32 {
+        uint32_t whitespace;
+        uint32_t op;
+        uint32_t quote;
+        uint32_t backslash;
+    };
+
+    // 64바이트 블록 (모든 SIMD 커널의 공통 처리 단위)
+    struct BlockMasks64 {
+        uint64_t whitespace;
+        uint64_t op;
+        uint64_t quote;
+        uint64_t backslash;
+    };
+
+    // vpshufb 두 번으로 모든 바이트의 클래스 비트를 구한다 (simdjson stage 1 방식)
+    CLAU_TARGET_AVX2 __forceinline __m256i classify_avx2(const __m256i chunk) {
+        const __m256i lo_tbl = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_table.lo)));
+        const __m256i hi_tbl = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_table.hi)));
+
+        // 0x80 이상 바이트는 vpshufb 가 0 을 돌려주므로 하위 nibble 마스킹 불필요
+        const __m256i lo = _mm256_shuffle_epi8(lo_tbl, chunk);
+        const __m256i hi = _mm256_shuffle_epi8(hi_tbl,
+            _mm256_and_si256(_mm256_srli_epi16(chunk, 4), _mm256_set1_epi8(0x0F)));
+        return _mm256_and_si256(lo, hi);
+    }
+
+    CLAU_TARGET_AVX2 __forceinline uint32_t class_mask_avx2(const __m256i cls, uint8_t bits) {
+        const __m256i hit = _mm256_cmpeq_epi8(
+            _mm256_and_si256(cls, _mm256_set1_epi8(static_cast<char>(bits))), _mm256_setzero_si256());
+        return ~static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+    }
+
+    CLAU_TARGET_AVX2 __forceinline BlockMasks32 get_block_masks_avx2(const __m256i chunk) {
+        const __m256i cls = classify_avx2(chunk);
+        return {
+            class_mask_avx2(cls, nibble_table.whitespace),
+            class_mask_avx2(cls, nibble_table.op),
+            class_mask_avx2(cls, nibble_table.quote),
+            class_mask_avx2(cls, nibble_table.backslash)
+        };
+    }
+
+    // 구분자 위치를 비트마스크로 뽑아내는 함수 (simdjson stage 1 변형)
+    CLAU_TARGET_AVX2 inline uint32_t get_delimiter_mask_avx2(const __m256i chunk) {
+        const __m256i cls = classify_avx2(chunk);
+        return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(cls, _mm256_setzero_si256())));
+    }
+
+    CLAU_TARGET_AVX2 __forceinline BlockMasks64 get_block_masks64_avx2(const char* p) {
+        const BlockMasks32 a = get_block_masks_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+        const BlockMasks32 b = get_block_masks_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)));
+        auto join = [](uint32_t lo, uint32_t hi) { return (static_cast<uint64_t>(hi) << 32) | lo; };
+        return { join(a.whitespace, b.whitespace), join(a.op, b.op),
+                 join(a.quote, b.quote), join(a.backslash, b.backslash) };
+    }
+
+    // ── SSE4.2 (pshufb 16바이트 × 4) ──────────────────────────────────
+    CLAU_TARGET_SSE42 __forceinline uint64_t class_mask_sse(const __m128i cls, uint8_t bits) {
+        const __m128i hit = _mm_cmpeq_epi8(
+            _mm_and_si128(cls, _mm_set1_epi8(static_cast<char>(bits))), _mm_setzero_si128());
+        return static_cast<uint16_t>(~_mm_movemask_epi8(hit));
+    }
+
+    CLAU_TARGET_SSE42 __forceinline BlockMasks64 get_block_masks64_sse(const char* p) {
+        const __m128i lo_tbl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_table.lo));
+        const __m128i hi_tbl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_table.hi));
+
+        BlockMasks64 m = { 0, 0, 0, 0 };
+        for (int k = 0; k < 4; ++k) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+            const __m128i cls = _mm_and_si128(_mm_shuffle_epi8(lo_tbl, chunk),
+                _mm_shuffle_epi8(hi_tbl, _mm_and_si128(_mm_srli_epi16(chunk, 4), _mm_set1_epi8(0x0F))));
+            m.whitespace |= class_mask_sse(cls, nibble_table.whitespace) << (16 * k);
+            m.op         |= class_mask_sse(cls, nibble_table.op) << (16 * k);
+            m.quote      |= class_mask_sse(cls, nibble_table.quote) << (16 * k);
+            m.backslash  |= class_mask_sse(cls, nibble_table.backslash) << (16 * k);
+        }
+        return m;
+    }
+
+    // ── AVX-512BW (64바이트 한 번에, 결과가 바로 mask 레지스터) ────────
+    CLAU_TARGET_AVX512 __forceinline BlockMasks64 get_block_masks64_avx512(const char* p) {
+        const __m512i lo_tbl = _mm512_maskz_broadcast_i32x4(0xFFFF,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_table.lo)));
+        const __m512i hi_tbl = _mm512_maskz_broadcast_i32x4(0xFFFF,
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibble_table.hi)));
+
+        const __m512i chunk = _mm512_loadu_si512(reinterpret_cast<const void*>(p));
+        const __m512i cls = _mm512_and_si512(_mm512_shuffle_epi8(lo_tbl, chunk),
+            _mm512_shuffle_epi8(hi_tbl, _mm512_and_si512(_mm512_srli_epi16(chunk, 4), _mm512_set1_epi8(0x0F))));
+        return {
+            _mm512_test_epi8_mask(cls, _mm512_set1_epi8(static_cast<char>(nibble_table.whitespace))),
+            _mm512_test_epi8_mask(cls, _mm512_set1_epi8(static_cast<char>(nibble_table.op))),
+            _mm512_test_epi8_mask(cls, _mm512_set1_epi8(static_cast<char>(nibble_table.quote))),
+            _mm512_test_epi8_mask(cls, _mm512_set1_epi8(static_cast<char>(nibble_table.backslash)))
+        };
+    }
+
+    // ── prefix XOR: 따옴표 사이(문자열 내부) 영역 마스크 ──────────────────
+    //  결과의 k 번째 비트 = x[0] ^ x[1] ^ ... ^ x[k]
+    __forceinline uint64_t prefix_xor(uint64_t x) {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    // 모든 비트가 1 인 값과의 carry-less 곱 = prefix XOR (명령 하나)
+    CLAU_TARGET_AVX2 __forceinline uint64_t prefix_xor_clmul(uint64_t x) {
+        const __m128i r = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(x)), _mm_set1_epi8(-1), 0);
+        return static_cast<uint64_t>(_mm_cvtsi128_si64(r));
+    }
+
+    // ── UTF-8 검증 (lookup 세 번, Keiser & Lemire) ────────────────────
+    //  (앞 바이트의 상위 nibble, 앞 바이트의 하위 nibble, 현재 바이트의 상위 nibble) 로
+    //  세 테이블을 찾아 AND 하면 그 바이트 쌍이 만드는 오류 종류 비트만 남는다.
+    //  3·4바이트 문자의 세 번째 / 네 번째 바이트는 두·세 칸 앞 바이트로 따로 확인한다.
+    //  stage 1 커널의 블록 루프 안에서 같은 64바이트 블록에 대해 부르고, 블록이 전부 ASCII 면 건너뛴다.
+    //  청크는 항상 ASCII 바이트(공백 / 구조문자) 에서 나뉘므로 청크 사이에 넘길 상태는 없다.
+    //  청크 끝에서 문자가 끝나지 않았으면 그 자체로 오류다.
+    namespace detail {
+        constexpr uint8_t kTooShort = 1 << 0;      // 11______ 다음에 0_______ / 11______
+        constexpr uint8_t kTooLong = 1 << 1;       // 0_______ 다음에 10______
+        constexpr uint8_t kOverlong3 = 1 << 2;     // 11100000 100_____
+        constexpr uint8_t kTooLarge = 1 << 3;      // 11110100 1001____ 이상
+        constexpr uint8_t kSurrogate = 1 << 4;     // 11101101 101_____
+        constexpr uint8_t kOverlong2 = 1 << 5;     // 1100000_ 10______
+        constexpr uint8_t kTooLarge1000 = 1 << 6;  // 11110101 이상 / 11111___ 10000000
+        constexpr uint8_t kOverlong4 = 1 << 6;     // 11110000 1000____
+        constexpr uint8_t kTwoConts = 1 << 7;      // 10______ 10______ (3·4바이트 문자면 정상)
+        constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+    }
+
+    struct Utf8Tables {
+        uint8_t byte_1_high[16];
+        uint8_t byte_1_low[16];
+        uint8_t byte_2_high[16];
+        uint8_t incomplete_max[64];  // 끝 세 바이트가 이 값보다 크면 문자가 블록 밖으로 이어진다
+    };
+
+    inline constexpr Utf8Tables utf8_tables = {
+        {
+            detail::kTooLong, detail::kTooLong, detail::kTooLong, detail::kTooLong,
+            detail::kTooLong, detail::kTooLong, detail::kTooLong, detail::kTooLong,
+            detail::kTwoConts, detail::kTwoConts, detail::kTwoConts, detail::kTwoConts,
+            detail::kTooShort | detail::kOverlong2,
+            detail::kTooShort,
+            detail::kTooShort | detail::kOverlong3 | detail::kSurrogate,
+            detail::kTooShort | detail::kTooLarge | detail::kTooLarge1000 | detail::kOverlong4
+        },
+        {
+            detail::kCarry | detail::kOverlong3 | detail::kOverlong2 | detail::kOverlong4,
+            detail::kCarry | detail::kOverlong2,
+            detail::kCarry,
+            detail::kCarry,
+            detail::kCarry | detail::kTooLarge,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000 | detail::kSurrogate,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000,
+            detail::kCarry | detail::kTooLarge | detail::kTooLarge1000
+        },
+        {
+            detail::kTooShort, detail::kTooShort, detail::kTooShort, detail::kTooShort,
+            detail::kTooShort, detail::kTooShort, detail::kTooShort, detail::kTooShort,
+            detail::kTooLong | detail::kOverlong2 | detail::kTwoConts | detail::kOverlong3 |
+                detail::kTooLarge1000 | detail::kOverlong4,
+            detail::kTooLong | detail::kOverlong2 | detail::kTwoConts | detail::kOverlong3 | detail::kTooLarge,
+            detail::kTooLong | detail::kOverlong2 | detail::kTwoConts | detail::kSurrogate | detail::kTooLarge,
+            detail::kTooLong | detail::kOverlong2 | detail::kTwoConts | detail::kSurrogate | detail::kTooLarge,
+            detail::kTooShort, detail::kTooShort, detail::kTooShort, detail::kTooShort
+        },
+        {
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+            0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+        }
+    };
+
+    // 바이트 단위 검증 (스칼라 커널, 오류 위치 찾기)
+    class Utf8Validator {
+    private:
+        int need = 0;           // 남은 continuation 바이트 수
+        uint8_t lo = 0x80, hi = 0xBF;  // 다음 continuation 바이트의 허용 범위
+        bool bad = false;
+
+    public:
+        // 문자 하나가 끝났거나 아직 이어지는 중이면 true
+        __forceinline bool Step(unsigned char c) {
+            if (need == 0) {
+                if (c < 0x80) return true;
+                lo = 0x80; hi = 0xBF;
+                if (c >= 0xC2 && c <= 0xDF) need = 1;
+                else if (c >= 0xE0 && c <= 0xEF) {
+                    need = 2;
+                    if (c == 0xE0) lo = 0xA0;       // overlong
+                    else if (c == 0xED) hi = 0x9F;  // surrogate
+                }
+                else if (c >= 0xF0 && c <= 0xF4) {
+                    need = 3;
+                    if (c == 0xF0) lo = 0x90;       // overlong
+                    else if (c == 0xF4) hi = 0x8F;  // U+10FFFF 초과
+                }
+                else { bad = true; return false; }
+                return true;
+            }
+            if (c < lo || c > hi) { bad = true; need = 0; return false; }
+            --need;
+            lo = 0x80; hi = 0xBF;
+            return true;
+        }
+
+        // 입력 끝에서 문자가 끝나지 않았어도 오류
+        bool Failed() const { return bad || need != 0; }
+
+        // 처음으로 잘못된 문자의 시작 위치 (없으면 -1). text 는 문자 경계에서 시작해야 한다
+        static int64_t FirstInvalid(const char* text, int64_t length) {
+            Utf8Validator v;
+            int64_t first = 0;  // 지금 문자의 시작
+            for (int64_t i = 0; i < length; ++i) {
+                if (v.need == 0) first = i;
+                if (!v.Step(static_cast<unsigned char>(text[i]))) return first;
+            }
+            return v.need != 0 ? first : -1;
+        }
+    };
+
+    struct Utf8CheckAvx2 {
+        __m256i error, prev_input, prev_incomplete;
+
+        CLAU_TARGET_AVX2 __forceinline void Reset() {
+            error = prev_input = prev_incomplete = _mm256_setzero_si256();
+        }
+
+        CLAU_TARGET_AVX2 static __forceinline __m256i Lookup(const uint8_t* table, __m256i nibble) {
+            return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(table))), nibble);
+        }
+
+        // 앞 벡터 끝 16 - N 바이트와 이어 붙여 N 칸 뒤로 민 벡터
+        template <int N>
+        CLAU_TARGET_AVX2 static __forceinline __m256i Prev(__m256i input, __m256i prev) {
+            return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+        }
+
+        CLAU_TARGET_AVX2 __forceinline void Check(__m256i input, __m256i prev) {
+            const __m256i low4 = _mm256_set1_epi8(0x0F);
+            const __m256i prev1 = Prev<1>(input, prev);
+            const __m256i special = _mm256_and_si256(_mm256_and_si256(
+                Lookup(utf8_tables.byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low4)),
+                Lookup(utf8_tables.byte_1_low, _mm256_and_si256(prev1, low4))),
+                Lookup(utf8_tables.byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), low4)));
+            // 두 칸 앞이 1110____ 이상, 세 칸 앞이 11110___ 이상이면 continuation 이어야 한다
+            const __m256i third = _mm256_subs_epu8(Prev<2>(input, prev), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+            const __m256i fourth = _mm256_subs_epu8(Prev<3>(input, prev), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+            const __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+            error = _mm256_or_si256(error, _mm256_xor_si256(must23, special));
+        }
+
+        CLAU_TARGET_AVX2 __forceinline void Block(const char* p) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+            if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) == 0) {  // 전부 ASCII
+                error = _mm256_or_si256(error, prev_incomplete);
+                return;
+            }
+            Check(a, prev_input);
+            Check(b, a);
+            prev_incomplete = _mm256_subs_epu8(b,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(utf8_tables.incomplete_max + 32)));
+            prev_input = b;
+        }
+
+        CLAU_TARGET_AVX2 __forceinline bool Failed() {
+            error = _mm256_or_si256(error, prev_incomplete);
+            return !_mm256_testz_si256(error, error);
+        }
+    };
+
+    struct Utf8CheckSse {
+        __m128i error, prev_input, prev_incomplete;
+
+        CLAU_TARGET_SSE42 __forceinline void Reset() {
+            error = prev_input = prev_incomplete = _mm_setzero_si128();
+        }
+
+        CLAU_TARGET_SSE42 static __forceinline __m128i Lookup(const uint8_t* table, __m128i nibble) {
+            return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)), nibble);
+        }
+
+        CLAU_TARGET_SSE42 __forceinline void Check(__m128i input, __m128i prev) {
+            const __m128i low4 = _mm_set1_epi8(0x0F);
+            const __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+            const __m128i special = _mm_and_si128(_mm_and_si128(
+                Lookup(utf8_tables.byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), low4)),
+                Lookup(utf8_tables.byte_1_low, _mm_and_si128(prev1, low4))),
+                Lookup(utf8_tables.byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), low4)));
+            const __m128i third = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 14), _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+            const __m128i fourth = _mm_subs_epu8(_mm_alignr_epi8(input, prev, 13), _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+            const __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+            error = _mm_or_si128(error, _mm_xor_si128(must23, special));
+        }
+
+        CLAU_TARGET_SSE42 __forceinline void Block(const char* p) {
+            __m128i in[4];
+            for (int k = 0; k < 4; ++k) in[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+            if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(in[0], in[1]), _mm_or_si128(in[2], in[3]))) == 0) {
+                error = _mm_or_si128(error, prev_incomplete);
+                return;
+            }
+            Check(in[0], prev_input);
+            Check(in[1], in[0]);
+            Check(in[2], in[1]);
+            Check(in[3], in[2]);
+            prev_incomplete = _mm_subs_epu8(in[3],
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8_tables.incomplete_max + 48)));
+            prev_input = in[3];
+        }
+
+        CLAU_TARGET_SSE42 __forceinline bool Failed() {
+            error = _mm_or_si128(error, prev_incomplete);
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF;
+        }
+    };
+
+    struct Utf8CheckAvx512 {
+        __m512i error, prev_input, prev_incomplete;
+
+        CLAU_TARGET_AVX512 __forceinline void Reset() {
+            error = prev_input = prev_incomplete = _mm512_setzero_si512();
+        }
+
+        CLAU_TARGET_AVX512 static __forceinline __m512i Lookup(const uint8_t* table, __m512i nibble) {
+            return _mm512_shuffle_epi8(_mm512_maskz_broadcast_i32x4(0xFFFF,
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(table))), nibble);
+        }
+
+        // 128비트 lane 을 하나씩 밀어 (앞 벡터 마지막 lane, 이번 벡터 lane 0~2) 를 만든 뒤 alignr
+        template <int N>
+        CLAU_TARGET_AVX512 static __forceinline __m512i Prev(__m512i input, __m512i prev) {
+            return _mm512_alignr_epi8(input,
+                _mm512_permutex2var_epi64(prev, _mm512_set_epi64(13, 12, 11, 10, 9, 8, 7, 6), input), 16 - N);
+        }
+
+        CLAU_TARGET_AVX512 __forceinline void Block(const char* p) {
+            const __m512i input = _mm512_loadu_si512(reinterpret_cast<const void*>(p));
+            if (_mm512_movepi8_mask(input) == 0) {
+                error = _mm512_or_si512(error, prev_incomplete);
+                return;
+            }
+            const __m512i low4 = _mm512_set1_epi8(0x0F);
+            const __m512i prev1 = Prev<1>(input, prev_input);
+            const __m512i special = _mm512_and_si512(_mm512_and_si512(
+                Lookup(utf8_tables.byte_1_high, _mm512_and_si512(_mm512_srli_epi16(prev1, 4), low4)),
+                Lookup(utf8_tables.byte_1_low, _mm512_and_si512(prev1, low4))),
+                Lookup(utf8_tables.byte_2_high, _mm512_and_si512(_mm512_srli_epi16(input, 4), low4)));
+            const __m512i third = _mm512_subs_epu8(Prev<2>(input, prev_input), _mm512_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+            const __m512i fourth = _mm512_subs_epu8(Prev<3>(input, prev_input), _mm512_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+            const __m512i must23 = _mm512_and_si512(_mm512_or_si512(third, fourth), _mm512_set1_epi8(static_cast<char>(0x80)));
+            error = _mm512_or_si512(error, _mm512_xor_si512(must23, special));
+            prev_incomplete = _mm512_subs_epu8(input, _mm512_loadu_si512(reinterpret_cast<const void*>(utf8_tables.incomplete_max)));
+            prev_input = input;
+        }
+
+        CLAU_TARGET_AVX512 __forceinline bool Failed() {
+            error = _mm512_or_si512(error, prev_incomplete);
+            return _mm512_test_epi8_mask(error, error) != 0;
+        }
+    };
+
+    // ── 런타임 ISA 선택 ──────────────────────────────────────────────
+    enum class SimdLevel { SCALAR, SSE42, AVX2, AVX512 };
+
+    class CpuFeatures {
+    public:
+        // CPUID + XGETBV(OS 가 YMM/ZMM 상태를 저장하는지)까지 확인
+        static SimdLevel Detect() {
+            uint32_t r[4];
+            clau_compat::cpuid(0, 0, r);
+            const uint32_t max_leaf = r[0];
+            if (max_leaf < 1) return SimdLevel::SCALAR;
+
+            clau_compat::cpuid(1, 0, r);
+            const bool pclmul = (r[2] >> 1) & 1;
+            const bool ssse3 = (r[2] >> 9) & 1;
+            const bool sse42 = (r[2] >> 20) & 1;
+            const bool popcnt = (r[2] >> 23) & 1;
+            const bool osxsave = (r[2] >> 27) & 1;
+            const bool avx = (r[2] >> 28) & 1;
+            if (!(ssse3 && sse42 && popcnt)) return SimdLevel::SCALAR;
+            if (!(osxsave && avx)) return SimdLevel::SSE42;
+
+            const uint64_t xcr0 = clau_compat::xgetbv0();
+            if ((xcr0 & 0x6) != 0x6 || max_leaf < 7) return SimdLevel::SSE42;
+
+            clau_compat::cpuid(7, 0, r);
+            const bool bmi1 = (r[1] >> 3) & 1;
+            const bool avx2 = (r[1] >> 5) & 1;
+            const bool bmi2 = (r[1] >> 8) & 1;
+            const bool avx512f = (r[1] >> 16) & 1;
+            const bool avx512bw = (r[1] >> 30) & 1;
+            if (!(avx2 && bmi1 && bmi2 && pclmul)) return SimdLevel::SSE42;
+            if (avx512f && avx512bw && (xcr0 & 0xE6) == 0xE6) return SimdLevel::AVX512;
+            return SimdLevel::AVX2;
+        }
+
+        // 프로세스 시작 시 한 번만 검사
+        static SimdLevel Best() {
+            static const SimdLevel level = Detect();
+            return level;
+        }
+
+        // 명시적으로 요청한 수준을 CPU 가 지원하는 범위로 제한
+        static SimdLevel Clamp(SimdLevel requested) {
+            return requested < Best() ? requested : Best();
+        }
+
+        static const char* Name(SimdLevel level) {
+            switch (level) {
+            case SimdLevel::AVX512: return "avx512";
+            case SimdLevel::AVX2:   return "avx2";
+            case SimdLevel::SSE42:  return "sse42";
+            default:                return "scalar";
+            }
+        }
+
+        static bool Parse(const std::string& name, SimdLevel& out) {
+            for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+                if (name == Name(level)) { out = level; return true; }
+            }
+            return false;
+        }
+    };
+
+    // 토큰 = 입력 버퍼 안의 바이트 오프셋.
+    // 기본은 32비트(대역폭 절약), 4GiB 를 넘는 입력은 64비트 토큰으로 스캔한다.
+    using Token = uint32_t;
+    using Token64 = uint64_t;
+
+    template <class TokenT>
+    constexpr bool TokenFits(int64_t length) {
+        return static_cast<uint64_t>(length) <= static_cast<uint64_t>(std::numeric_limits<TokenT>::max());
+    }
+
+    enum TokenType {
+        LEFT_BRACE, RIGHT_BRACE, LEFT_BRACKET, RIGHT_BRACKET,
+        ASSIGNMENT, COMMA, COLON,
+        BACK_SLUSH, QUOTED,
+        STRING, NUMBER, TRUE, FALSE, _NULL, END
+    };
+
+
+    class Utility {
+    private:
+        class BomInfo {
+        public:
+            int64_t bom_size;
+            char seq[5];
+        };
+
+        static const int64_t BOM_COUNT = 1;
+        static const BomInfo bomInfo[1];
+
+    public:
+        enum class BomType { UTF_8, ANSI };
+
+        static BomType ReadBom(FILE* file) {
+            char btBom[5] = { 0 };
+            int64_t readSize = static_cast<int64_t>(fread(btBom, sizeof(char), 5, file));
+
+            if (0 == readSize) {
+                clearerr(file);
+                fseek(file, 0, SEEK_SET);
+                return BomType::ANSI;
+            }
+
+            BomInfo stBom = { 0 };
+            BomType type = ReadBom(btBom, readSize, stBom);
+
+            if (type == BomType::ANSI) {
+                clearerr(file);
+                fseek(file, 0, SEEK_SET);
+                return BomType::ANSI;
+            }
+
+            clearerr(file);
+            fseek(file, static_cast<long>(stBom.bom_size * sizeof(char)), SEEK_SET);
+            return type;
+        }
+
+        // 메모리 위 내용의 BOM 길이 (없으면 0)
+        static int64_t BomSize(const char* contents, int64_t length) {
+            if (!contents || length <= 0) return 0;
+            BomInfo info = { 0, { 0 } };
+            if (ReadBom(contents, length, info) == BomType::ANSI) return 0;
+            return info.bom_size;
+        }
+
+        static BomType ReadBom(const char* contents, int64_t length, BomInfo& outInfo) {
+            char btBom[5] = { 0 };
+            int64_t testLength = length < 5 ? length : 5;
+            memcpy(btBom, contents, static_cast<size_t>(testLength));
+
+            for (int64_t i = 0; i < BOM_COUNT; ++i) {
+                const BomInfo& bom = bomInfo[i];
+                if (bom.bom_size > testLength) continue;
+
+                bool matched = true;
+                for (int64_t j = 0; j < bom.bom_size; ++j) {
+                    if (bom.seq[j] != btBom[j]) { matched = false; break; }
+                }
+                if (!matched) continue;
+
+                outInfo = bom;
+                return static_cast<BomType>(i);
+            }
+            return BomType::ANSI;
+        }
+
+    public:
+        static __forceinline bool isWhitespace(const char ch) {
+            switch (ch) {
+            case ' ': case '\t': case '\r': case '\n': case '\v': case '\f':
+                return true;
+            }
+            return false;
+        }
+
+        static __forceinline int Equal(const int64_t x, const int64_t y) {
+            return (x == y) ? 0 : -1;
+        }
+
+        static void skipWhitespace(char* buf, int64_t& token_first, int64_t& token_last) {
+            while (token_first <= token_last && isWhitespace(buf[token_first])) token_first++;
+            while (token_first <= token_last && isWhitespace(buf[token_last]))  token_last--;
+        }
+
+        // position 이 TokenT 범위 안인지는 스캔 전에 TokenFits 로 확인한다
+        template <class TokenT = Token>
+        static __forceinline TokenT Get(int64_t position, int64_t /*length*/, const char* /*ch*/) {
+            return static_cast<TokenT>(position);
+        }
+
+        static __forceinline TokenType GetType(const char ch) {
+            switch (ch) {
+            case LoadDataOption::LeftBrace:    return TokenType::LEFT_BRACE;
+            case LoadDataOption::RightBrace:   return TokenType::RIGHT_BRACE;
+            case LoadDataOption::LeftBracket:  return TokenType::LEFT_BRACKET;
+            case LoadDataOption::RightBracket: return TokenType::RIGHT_BRACKET;
+            case LoadDataOption::Assignment:   return TokenType::ASSIGNMENT;
+            case LoadDataOption::Comma:        return TokenType::COMMA;
+            case '\\':                         return TokenType::BACK_SLUSH;
+            case '\"':                         return TokenType::QUOTED;
+            default:                           return TokenType::STRING;
+            }
+        }
+
+        // 토큰 원문의 끝 : 다음 토큰 위치 next 에서 뒤쪽 공백을 걷어낸 곳 (첫 바이트는 남긴다)
+        static __forceinline int64_t TokenEnd(const char* text, int64_t first, int64_t next) {
+            while (next > first + 1 && isWhitespace(text[next - 1])) --next;
+            return next;
+        }
+
+        // 값의 첫 바이트 → 값 종류. 따옴표는 STRING, word 는 첫 글자로 TRUE / FALSE / _NULL / NUMBER
+        // (word 가 정말 그 리터럴인지는 해석할 때 확인한다)
+        static constexpr TokenType GetValueType(const char ch) {
+            switch (ch) {
+            case LoadDataOption::LeftBrace:    return TokenType::LEFT_BRACE;
+            case LoadDataOption::RightBrace:   return TokenType::RIGHT_BRACE;
+            case LoadDataOption::LeftBracket:  return TokenType::LEFT_BRACKET;
+            case LoadDataOption::RightBracket: return TokenType::RIGHT_BRACKET;
+            case LoadDataOption::Assignment:   return TokenType::ASSIGNMENT;
+            case LoadDataOption::Comma:        return TokenType::COMMA;
+            case '\"':                         return TokenType::STRING;
+            case 't':                          return TokenType::TRUE;
+            case 'f':                          return TokenType::FALSE;
+            case 'n':                          return TokenType::_NULL;
+            default:                           return TokenType::NUMBER;
+            }
+        }
+
+        template <class TokenT>
+        static void PrintToken(std::ostream& out, const char* buffer, const TokenT& token) {
+            if (out) {
+                size_t len = static_cast<size_t>(*((&token) + 1) - token);
+                out << std::string_view(buffer + token, len);
+            }
+        }
+    };
+
+    // BomInfo 정의 (UTF-8 BOM: EF BB BF)
+    inline const Utility::BomInfo Utility::bomInfo[1] = {
+        { 3, { '\xEF', '\xBB', '\xBF', 0, 0 } }
+    };
+
+    // 토큰 첫 바이트 → TokenType (GetValueType 을 표로). stage 1 이 토큰 종류 배열을 채울 때 쓴다
+    namespace detail {
+        constexpr std::array<uint8_t, 256> MakeTokenTypeTable() {
+            std::array<uint8_t, 256> table{};
+            for (int c = 0; c < 256; ++c)
+                table[c] = static_cast<uint8_t>(Utility::GetValueType(static_cast<char>(c)));
+            return table;
+        }
+    }
+    inline constexpr std::array<uint8_t, 256> char_to_token_type = detail::MakeTokenTypeTable();
+
+
+    // ── 스칼라 값 (숫자 / 리터럴) ─────────────────────────────────────
+    //  문자열이 아닌 값 토큰 하나의 해석 결과. 구조문자와 문자열 토큰은 NONE
+    enum class ScalarKind : uint8_t { NONE, INT64, DOUBLE, TRUE, FALSE, _NULL, INVALID };
+
+    union ScalarValue {
+        int64_t i;
+        double d;
+    };
+
+    class NumberParser {
+    public:
+        // [p, end) 의 word 하나를 해석한다 (리터럴 또는 JSON 숫자). 문법에 맞지 않으면 INVALID
+        static ScalarKind Classify(const char* p, const char* end, ScalarValue& out) {
+            switch (end - p) {
+            case 4:
+                if (memcmp(p, "true", 4) == 0) return ScalarKind::TRUE;
+                if (memcmp(p, "null", 4) == 0) return ScalarKind::_NULL;
+                break;
+            case 5:
+                if (memcmp(p, "false", 5) == 0) return ScalarKind::FALSE;
+                break;
+            }
+            return Parse(p, end, out);
+        }
+
+        // JSON 숫자 하나. 정수가 int64 에 들어가면 INT64, 아니면 DOUBLE
+        //  - 숫자는 8자리씩 SWAR 로 변환
+        //  - 유효 숫자 19 자리 이하, 가수 <= 2^53, |10진 지수| <= 22 면 double 곱셈/나눗셈 한 번으로 정확 (Clinger)
+        //  - 유효 숫자 19 자리 이하, |10진 지수| <= 64 면 5^q 의 128비트 근사와 곱해 반올림 (Eisel-Lemire)
+        //  - 그 밖이나 반올림 경계에 걸리면 std::from_chars (올바른 반올림). 범위를 넘는 값(1e400 등)은 INVALID,
+        //    0 에 가까워 double 로 표현되지 않는 값(1e-400 등)은 부호 있는 0
+        static ScalarKind Parse(const char* p, const char* end, ScalarValue& out) {
+            const char* const start = p;
+            const bool negative = p < end && *p == '-';
+            if (negative) ++p;
+            if (p == end || !IsDigit(*p)) return ScalarKind::INVALID;
+
+            uint64_t mantissa = 0;
+            int64_t digits = 0;    // mantissa 에 들어간 유효 숫자 수 (앞의 0 제외)
+            int64_t exponent = 0;  // 10진 지수
+            bool integer = true;
+
+            if (*p == '0') {
+                ++p;
+                if (p < end && IsDigit(*p)) return ScalarKind::INVALID;  // 01
+            }
+            else {
+                p = Digits(p, end, mantissa, digits);
+            }
+
+            if (p < end && *p == '.') {
+                integer = false;
+                const char* const frac = ++p;
+                if (mantissa == 0)
+                    while (p < end && *p == '0') ++p;  // 0.000123 : 앞의 0 은 유효 숫자가 아님
+                p = Digits(p, end, mantissa, digits);
+                if (p == frac) return ScalarKind::INVALID;
+                exponent -= p - frac;
+            }
+
+            if (p < end && (*p == 'e' || *p == 'E')) {
+                integer = false;
+                ++p;
+                bool negative_exp = false;
+                if (p < end && (*p == '+' || *p == '-')) negative_exp = *p++ == '-';
+                if (p == end || !IsDigit(*p)) return ScalarKind::INVALID;
+                int64_t e = 0;
+                for (; p < end && IsDigit(*p); ++p)
+                    if (e < 100000) e = e * 10 + (*p - '0');
+                exponent += negative_exp ? -e : e;
+            }
+            if (p != end) return ScalarKind::INVALID;
+
+            if (digits <= 19) {
+                if (integer) {
+                    if (!negative && mantissa <= static_cast<uint64_t>(INT64_MAX)) {
+                        out.i = static_cast<int64_t>(mantissa);
+                        return ScalarKind::INT64;
+                    }
+                    if (negative && mantissa <= uint64_t(1) << 63) {
+                        out.i = static_cast<int64_t>(0 - mantissa);
+                        return ScalarKind::INT64;
+                    }
+                }
+                else if (mantissa <= uint64_t(1) << 53 && exponent >= -22 && exponent <= 22) {
+                    double d = static_cast<double>(mantissa);
+                    d = exponent < 0 ? d / kPow10[-exponent] : d * kPow10[exponent];
+                    out.d = negative ? -d : d;
+                    return ScalarKind::DOUBLE;
+                }
+                if (EiselLemire(mantissa, exponent, negative, out.d)) return ScalarKind::DOUBLE;
+            }
+
+            double d = 0;
+            const auto r = std::from_chars(start, end, d);
+            if (r.ptr != end) return ScalarKind::INVALID;
+            if (r.ec == std::errc::result_out_of_range) {
+                // 크기 = mantissa(digits 자리) × 10^exponent. 1 보다 작으면 underflow 라 0 으로 (부호 유지), 크면 overflow
+                if (digits + exponent > 0) return ScalarKind::INVALID;
+                d = negative ? -0.0 : 0.0;
+            }
+            else if (r.ec != std::errc()) return ScalarKind::INVALID;
+            out.d = d;
+            return ScalarKind::DOUBLE;
+        }
+
+    private:
+        // 5^q 의 상위 128비트 (q = kPow5Min .. kPow5Max, 최상위 비트가 1 이 되게 정규화).
+        // q < 0 은 2^b / 5^-q 를 올림한 값. fast_float 와 같은 방식으로 만든 표의 일부
+        static constexpr int64_t kPow5Min = -64;
+        static constexpr int64_t kPow5Max = 64;
+        static constexpr uint64_t kPow5[2 * (kPow5Max - kPow5Min + 1)] = {
+            0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, 0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+            0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, 0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+            0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, 0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+            0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, 0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+            0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, 0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+            0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, 0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+            0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, 0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+            0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, 0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+            0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, 0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+            0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, 0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+            0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, 0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+            0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, 0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+            0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, 0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+            0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, 0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+            0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, 0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+            0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, 0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+            0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, 0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+            0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, 0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+            0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, 0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+            0xc612062576589ddaULL, 0x95364afe032a819eULL, 0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+            0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, 0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+            0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, 0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+            0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, 0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+            0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, 0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+            0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, 0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+            0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, 0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+            0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, 0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+            0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, 0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+            0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, 0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+            0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, 0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+            0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, 0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+            0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, 0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+            0x8000000000000000ULL, 0x0000000000000000ULL, 0xa000000000000000ULL, 0x0000000000000000ULL,
+            0xc800000000000000ULL, 0x0000000000000000ULL, 0xfa00000000000000ULL, 0x0000000000000000ULL,
+            0x9c40000000000000ULL, 0x0000000000000000ULL, 0xc350000000000000ULL, 0x0000000000000000ULL,
+            0xf424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+            0xbebc200000000000ULL, 0x0000000000000000ULL, 0xee6b280000000000ULL, 0x0000000000000000ULL,
+            0x9502f90000000000ULL, 0x0000000000000000ULL, 0xba43b74000000000ULL, 0x0000000000000000ULL,
+            0xe8d4a51000000000ULL, 0x0000000000000000ULL, 0x9184e72a00000000ULL, 0x0000000000000000ULL,
+            0xb5e620f480000000ULL, 0x0000000000000000ULL, 0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+            0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, 0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+            0xde0b6b3a76400000ULL, 0x0000000000000000ULL, 0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+            0xad78ebc5ac620000ULL, 0x0000000000000000ULL, 0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+            0x878678326eac9000ULL, 0x0000000000000000ULL, 0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+            0xd3c21bcecceda100ULL, 0x0000000000000000ULL, 0x84595161401484a0ULL, 0x0000000000000000ULL,
+            0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, 0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+            0x813f3978f8940984ULL, 0x4000000000000000ULL, 0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+            0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, 0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+            0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, 0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+            0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, 0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+            0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, 0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+            0x96769950b50d88f4ULL, 0x1314448000000000ULL, 0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+            0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+            0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, 0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+            0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, 0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+            0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, 0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+            0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+            0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, 0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+            0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, 0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+            0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, 0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+            0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+            0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, 0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+            0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, 0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+            0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, 0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+            0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL
+        };
+
+        // mantissa * 10^exponent → double (mantissa 는 19 자리 이하의 정확한 값).
+        // 곱의 잘린 부분 때문에 반올림이 애매하면 false (→ from_chars)
+        static bool EiselLemire(uint64_t mantissa, int64_t exponent, bool negative, double& out) {
+            if (mantissa == 0) {
+                out = negative ? -0.0 : 0.0;
+                return true;
+            }
+            if (exponent < kPow5Min || exponent > kPow5Max) return false;
+
+            const uint64_t* factor = kPow5 + 2 * (exponent - kPow5Min);
+            int lz = clau_compat::clz64(mantissa);
+            const uint64_t w = mantissa << lz;
+
+            uint64_t lower;
+            uint64_t upper = clau_compat::mul128(w, factor[0], lower);
+            if ((upper & 0x1FF) == 0x1FF) {  // 하위 128비트까지 곱해 본다
+                uint64_t unused;
+                const uint64_t carry = clau_compat::mul128(w, factor[1], unused);
+                lower += carry;
+                if (lower < carry) ++upper;
+                if (lower == UINT64_MAX) return false;
+            }
+
+            const uint64_t upper_bit = upper >> 63;
+            uint64_t bits = upper >> (upper_bit + 9);
+            lz += static_cast<int>(1 ^ upper_bit);
+            if (lower <= 1 && (bits & 3) == 1) return false;  // 정확히 중간일 수 있음 (짝수 쪽 반올림)
+
+            int64_t binary_exponent = (((152170 + 65536) * exponent) >> 16) + 1024 + 63 - lz;
+            bits += bits & 1;
+            bits >>= 1;
+            if (bits >= uint64_t(1) << 53) {
+                bits = uint64_t(1) << 52;
+                ++binary_exponent;
+            }
+            if (binary_exponent < 1 || binary_exponent > 2046) return false;  // subnormal / inf
+
+            bits &= ~(uint64_t(1) << 52);
+            bits |= static_cast<uint64_t>(binary_exponent) << 52;
+            bits |= static_cast<uint64_t>(negative) << 63;
+            memcpy(&out, &bits, sizeof(out));
+            return true;
+        }
+
+        static constexpr double kPow10[23] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        static __forceinline bool IsDigit(char ch) { return static_cast<unsigned char>(ch - '0') < 10; }
+
+        // 8바이트가 모두 '0'..'9' 인가
+        static __forceinline bool IsEightDigits(uint64_t v) {
+            return ((v & 0xF0F0F0F0F0F0F0F0ULL) |
+                (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+        }
+
+        // 8자리 → 정수 (첫 글자가 하위 바이트, little endian)
+        static __forceinline uint64_t ParseEightDigits(uint64_t v) {
+            v -= 0x3030303030303030ULL;
+            v = (v * 10) + (v >> 8);
+            v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+                (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+            return v;
+        }
+
+        // 숫자가 이어지는 동안 mantissa 에 더하고 자리 수를 센다. 19 자리를 넘으면 mantissa 는 넘쳐 의미가 없지만
+        // 분기 없이 계속 곱한다 : Parse 는 digits > 19 이면 mantissa 를 쓰지 않고 from_chars 로 간다
+        static __forceinline const char* Digits(const char* p, const char* end, uint64_t& mantissa, int64_t& digits) {
+            while (end - p >= 8) {
+                uint64_t v;
+                memcpy(&v, p, 8);
+                if (!IsEightDigits(v)) break;
+                mantissa = mantissa * 100000000 + ParseEightDigits(v);
+                digits += 8;
+                p += 8;
+            }
+            for (; p < end && IsDigit(*p); ++p) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                ++digits;
+            }
+            return p;
+        }
+    };
+
+
+    // ── 상주 워커 풀 ─────────────────────────────────────────────────
+    //  로드마다/단계마다 스레드를 만들고 join 하지 않고, 같은 워커를 계속 재사용한다.
+    //  - Run(n, fn)  : fn(0) 은 호출 스레드, fn(1..n-1) 은 워커가 실행. 전원 끝나면 반환
+    //  - Barrier(f)  : Run 안에서 단계 구분. 마지막 도착자가 f() 를 실행한 뒤 전원 진행
+    //  - 대기는 spin → park(condition_variable) 순서
+    class WorkerPool {
+    private:
+        std::vector<std::thread> workers;
+        std::vector<int> cpus;
+        bool pin = true;
+        int spin_limit = 1 << 12;
+
+        std::mutex mtx;
+        std::condition_variable cv_work, cv_done, cv_barrier;
+        std::atomic<bool> stop{ false };
+        std::atomic<bool> oversubscribed{ false };
+
+        // (일련번호 << 16) | 참가자 수. 한 번에 읽어야 이전 작업의 참가자 수와 섞이지 않는다
+        std::atomic<uint64_t> generation{ 0 };
+        std::atomic<int> pending{ 0 };
+        const std::function<void(int)>* job = nullptr;
+        int job_size = 0;  // Barrier 용 (참가자만 읽음)
+
+        std::atomic<int> barrier_arrived{ 0 };
+        std::atomic<uint64_t> barrier_generation{ 0 };
+
+        // 참가 스레드가 코어 수보다 많으면 spin 은 다른 참가자의 CPU 를 뺏을 뿐이므로 바로 park
+        template <class Ready>
+        void SpinThenPark(std::condition_variable& cv, Ready ready) {
+            const int limit = oversubscribed.load(std::memory_order_relaxed) ? 0 : spin_limit;
+            for (int k = 0; k < limit; ++k) {
+                if (ready()) return;
+                _mm_pause();
+            }
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, ready);
+        }
+
+        // 상태 변경 후 mutex 를 한 번 거쳐야 park 중인 쪽이 신호를 놓치지 않는다
+        void Wake(std::condition_variable& cv) {
+            { std::lock_guard<std::mutex> lock(mtx); }
+            cv.notify_all();
+        }
+
+        void WorkerMain(int id) {
+            if (pin && !cpus.empty()) clau_compat::pin_current_thread(cpus[id % cpus.size()]);
+
+            uint64_t seen = 0;
+            while (true) {
+                SpinThenPark(cv_work, [&] {
+                    return stop.load(std::memory_order_acquire) ||
+                        generation.load(std::memory_order_acquire) != seen;
+                    });
+                if (stop.load(std::memory_order_acquire)) return;
+                seen = generation.load(std::memory_order_acquire);
+                if (id >= static_cast<int>(seen & 0xFFFF)) continue;
+
+                (*job)(id);
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) Wake(cv_done);
+            }
+        }
+
+        void EnsureWorkers(int count) {
+            while (static_cast<int>(workers.size()) < count) {
+                const int id = static_cast<int>(workers.size()) + 1;
+                workers.emplace_back(&WorkerPool::WorkerMain, this, id);
+            }
+        }
+
+    public:
+        WorkerPool() = default;
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        ~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                stop.store(true, std::memory_order_release);
+            }
+            cv_work.notify_all();
+            for (auto& t : workers) t.join();
+        }
+
+        // 이미 만들어진 워커에는 적용되지 않으므로 첫 Run 전에 설정.
+        // 워커 w 는 topology_order 의 w 번째 CPU 에 고정된다 (0 번은 호출 스레드라 고정하지 않는다)
+        void SetPinThreads(bool on) { pin = on; }
+        void SetSpinLimit(int limit) { spin_limit = limit; }
+        int Size() const { return static_cast<int>(workers.size()) + 1; }
+
+        void Run(int n, const std::function<void(int)>& fn) {
+            if (cpus.empty()) cpus = clau_compat::topology_order(clau_compat::allowed_cpus());
+            n = std::min(n, 0xFFFF);
+            if (n <= 1) { job_size = 1; fn(0); return; }
+            EnsureWorkers(n - 1);
+            oversubscribed.store(n > static_cast<int>(cpus.size()), std::memory_order_relaxed);
+
+            job = &fn;
+            job_size = n;
+            pending.store(n - 1, std::memory_order_relaxed);
+            barrier_arrived.store(0, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                const uint64_t seq = (generation.load(std::memory_order_relaxed) >> 16) + 1;
+                generation.store((seq << 16) | static_cast<uint64_t>(n), std::memory_order_release);
+            }
+            cv_work.notify_all();
+
+            fn(0);
+            SpinThenPark(cv_done, [&] { return pending.load(std::memory_order_acquire) == 0; });
+            job = nullptr;
+        }
+
+        template <class Serial>
+        void Barrier(Serial serial) {
+            if (job_size <= 1) { serial(); return; }
+
+            const uint64_t gen = barrier_generation.load(std::memory_order_acquire);
+            if (barrier_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == job_size) {
+                serial();
+                barrier_arrived.store(0, std::memory_order_relaxed);
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    barrier_generation.fetch_add(1, std::memory_order_release);
+                }
+                cv_barrier.notify_all();
+            }
+            else {
+                SpinThenPark(cv_barrier, [&] {
+                    return barrier_generation.load(std::memory_order_acquire) != gen;
+                    });
+            }
+        }
+    };
+
+
+    // ── 청크 분배 (work stealing) ────────────────────────────────────
+    //  항목 [0, n) 을 워커마다 연속 구간으로 나눠 주고, 자기 구간은 앞에서부터,
+    //  일이 떨어진 워커는 다른 워커 구간의 뒤에서부터 가져간다.
+    //  구간은 (front << 32 | back) 하나의 atomic 이라 CAS 한 번으로 꺼낸다.
+    class StealingScheduler {
+    private:
+        struct alignas(64) Range {
+            std::atomic<uint64_t> word{ 0 };
+        };
+
+        std::vector<Range> ranges;
+        int worker_num = 0;
+
+        static uint64_t Pack(uint32_t front, uint32_t back) { return (uint64_t(front) << 32) | back; }
+
+    public:
+        // Run 밖 또는 Barrier 의 serial 구간에서만 호출
+        void Reset(int64_t item_num, int workers) {
+            worker_num = std::max(workers, 1);
+            if (static_cast<int>(ranges.size()) < worker_num) ranges = std::vector<Range>(worker_num);
+            for (int w = 0; w < worker_num; ++w) {
+                const uint32_t front = static_cast<uint32_t>(item_num * w / worker_num);
+                const uint32_t back = static_cast<uint32_t>(item_num * (w + 1) / worker_num);
+                ranges[w].word.store(Pack(front, back), std::memory_order_relaxed);
+            }
+        }
+
+        bool Next(int worker, int64_t& item) {
+            // 자기 구간 앞쪽
+            {
+                auto& r = ranges[worker].word;
+                uint64_t w = r.load(std::memory_order_acquire);
+                while (static_cast<uint32_t>(w >> 32) < static_cast<uint32_t>(w)) {
+                    const uint32_t front = static_cast<uint32_t>(w >> 32);
+                    if (r.compare_exchange_weak(w, Pack(front + 1, static_cast<uint32_t>(w)), std::memory_order_acq_rel)) {
+                        item = front;
+                        return true;
+                    }
+                }
+            }
+            // 다른 워커 구간 뒤쪽에서 훔친다
+            for (int k = 1; k < worker_num; ++k) {
+                auto& r = ranges[(worker + k) % worker_num].word;
+                uint64_t w = r.load(std::memory_order_acquire);
+                while (static_cast<uint32_t>(w >> 32) < static_cast<uint32_t>(w)) {
+                    const uint32_t back = static_cast<uint32_t>(w) - 1;
+                    if (r.compare_exchange_weak(w, Pack(static_cast<uint32_t>(w >> 32), back), std::memory_order_acq_rel)) {
+                        item = back;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+    };
+
+
+    // ── 토큰 저장 방식 ───────────────────────────────────────────────
+    //  ARENAS      : 청크별 아레나에 한 번에 스캔 (빠름). 연속 배열이 필요하면 한 번 더 복사
+    //  COUNT_FIRST : 개수만 세는 스캔 → prefix sum → 연속 배열에 바로 기록 (스캔 두 번, 메모리 최소)
+    enum class TokenStorage { ARENAS, COUNT_FIRST };
+
+    // ── 입력 방식 ─────────────────────────────────────────────────────
+    //  READ : 파일 전체를 버퍼로 fread (버퍼는 로드 사이에 재사용)
+    //  MMAP : 읽기 전용 매핑에서 바로 스캔 (복사 없음). 매핑은 다음 로드 전까지 유지
+    //         스캔은 NUL 종료나 끝 이후 읽기에 기대지 않으므로 매핑 끝까지만 읽는다.
+    //  PIPELINED : 세그먼트 단위 pread 와 stage 1 스캔을 겹친다 (cold cache 에서 I/O 뒤에 스캔을 숨김)
+    enum class InputMode { READ, MMAP, PIPELINED };
+
+    struct MapOptions {
+        bool populate = true;     // page cache 에 있는 파일이면 fault 없이 바로 스캔
+        bool sequential = true;
+        bool huge_pages = false;
+    };
+
+    struct PipelineOptions {
+        int64_t segment_size = int64_t(4) << 20;  // 읽기 단위이자 청크 단위
+        int     max_inflight_reads = 4;           // 동시에 읽기 중인 워커 수 상한 (스캔할 워커 하나는 남긴다)
+    };
+
+    // ── 로드 계측 ─────────────────────────────────────────────────────
+    //  SetStats 로 넘긴 객체를 로드마다 처음부터 다시 채운다. 넘기지 않으면 (기본) 시계도 읽지 않는다.
+    //  시간은 벽시계 나노초이며, 이번 로드에 없던 단계는 0. 창 단위 스캔은 창들의 합이다.
+    struct LoadStats {
+        enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTER_NUM };
+
+        // stage 1 워커 한 명의 몫 (첫 스캔 + 재스캔)
+        struct Worker {
+            int64_t bytes = 0;
+            int64_t tokens = 0;
+            int64_t chunks = 0;
+            int64_t busy_ns = 0;                   // 청크 스캔에 쓴 시간
+            int64_t counters[COUNTER_NUM] = {};    // counted 일 때만 의미가 있다
+            bool counted = false;
+        };
+
+        // 설정 : stage 1 워커마다 하드웨어 카운터도 읽는다 (Reset 해도 유지)
+        bool hardware_counters = false;
+
+        int64_t read_ns = 0;      // 파일 읽기 / 매핑 (PIPELINED 는 스캔과 겹치므로 scan_ns 에 들어간다)
+        int64_t scan_ns = 0;      // stage 1 : 추측한 시작 상태로 첫 스캔 (COUNT_FIRST 는 개수 세기)
+        int64_t stitch_ns = 0;    // 문자열 상태 보정 + 추측이 틀린 청크 재스캔
+        int64_t fill_ns = 0;      // stage 2 : COUNT_FIRST 의 기록 스캔
+        int64_t sentinel_ns = 0;  // 조각 정리 : 센티넬을 붙이고 연속 배열로 모은다
+        int64_t grammar_ns = 0;
+        int64_t records_ns = 0;
+        int64_t tape_ns = 0;
+        int64_t brackets_ns = 0;
+        int64_t scalars_ns = 0;
+        int64_t total_ns = 0;     // LoadDataFromFile 전체
+
+        int64_t bytes = 0;        // 스캔한 입력 (BOM 제외)
+        int64_t tokens = 0;
+        int64_t chunks = 0;
+        int64_t rescanned = 0;    // 시작 상태 추측이 틀려 다시 스캔한 청크
+        std::vector<Worker> workers;  // 워커 번호 순
+
+        // 할당 크기 (바이트)
+        int64_t input_bytes = 0;   // READ / PIPELINED / 창 버퍼, MMAP 이면 매핑
+        int64_t token_bytes = 0;   // stage 1 토큰 저장소 (아레나 용량 합 또는 연속 배열, 종류 배열 포함)
+        int64_t dense_bytes = 0;   // ARENAS 조각을 모은 연속 배열 (종류 배열 포함)
+        int64_t tape_bytes = 0;
+        int64_t bracket_bytes = 0;
+        int64_t scalar_bytes = 0;
+        int64_t record_bytes = 0;
+        int64_t peak_rss = 0;
+
+        static int64_t Now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+        // 계측을 켰을 때만 시계를 읽는다
+        static int64_t Clock(const LoadStats* stats) { return stats ? Now() : 0; }
+
+        void Reset() {
+            const bool counters = hardware_counters;
+            *this = LoadStats();
+            hardware_counters = counters;
+        }
+
+        // 워커 busy_ns 의 최댓값 / 평균 (일한 워커만. 1 이 고른 분배, 워커가 없으면 0)
+        double Imbalance() const {
+            int64_t sum = 0, top = 0, n = 0;
+            for (const auto& w : workers) {
+                if (w.chunks == 0) continue;
+                sum += w.busy_ns;
+                top = std::max(top, w.busy_ns);
+                ++n;
+            }
+            return sum > 0 ? static_cast<double>(top) * n / sum : 0.0;
+        }
+
+        // 워커 합. 카운터를 읽지 않았거나 열 수 없었으면 -1
+        int64_t HardwareCounter(Counter c) const {
+            int64_t sum = -1;
+            for (const auto& w : workers)
+                if (w.counted) sum = std::max<int64_t>(sum, 0) + w.counters[c];
+            return sum;
+        }
+
+        // 사람이 읽는 요약 (단계별 ms, 워커별 몫, 할당 크기)
+        void Print(std::ostream& out) const {
+            auto line = [&](const std::string& label, int64_t ns) {
+                if (ns > 0) out << label << " \t" << ns / 1e6 << "ms\n";
+                };
+            line("파일 읽기", read_ns);
+            line("토큰 배열 구성(parallel, " + std::to_string(chunks) + " 청크)", scan_ns);
+            line("문자열 상태 보정(" + std::to_string(rescanned) + " 청크 재스캔)", stitch_ns);
+            line("토큰 배열 구성(연속 배열에 바로 기록)", fill_ns);
+            line("센티넬 + 연속 배열", sentinel_ns);
+            line("문법 검증", grammar_ns);
+            line("레코드 인덱스", records_ns);
+            line("테이프 구성", tape_ns);
+            line("괄호 짝 인덱스", brackets_ns);
+            line("스칼라 값 해석", scalars_ns);
+            line("전체", total_ns);
+            out << "입력 " << bytes << " 바이트, 토큰 " << tokens << "\n";
+            for (size_t w = 0; w < workers.size(); ++w) {
+                if (workers[w].chunks == 0) continue;
+                out << "워커 " << w << " \t" << workers[w].chunks << " 청크, " << workers[w].bytes << " 바이트, "
+                    << workers[w].tokens << " 토큰, " << workers[w].busy_ns / 1e6 << "ms\n";
+            }
+            out << "청크 불균형 " << Imbalance() << "\n";
+            out << "할당 : 입력 " << (input_bytes >> 20) << "MB, 토큰 " << (token_bytes >> 20)
+                << "MB, 연속 배열 " << (dense_bytes >> 20) << "MB, 테이프 " << (tape_bytes >> 20)
+                << "MB, 괄호 " << (bracket_bytes >> 20) << "MB, 스칼라 " << (scalar_bytes >> 20)
+                << "MB, 레코드 " << (record_bytes >> 20) << "MB, peak rss " << (peak_rss >> 20) << "MB\n";
+            if (HardwareCounter(CYCLES) >= 0) {
+                out << "cycles " << HardwareCounter(CYCLES) << ", instructions " << HardwareCounter(INSTRUCTIONS)
+                    << ", cache-misses " << HardwareCounter(CACHE_MISSES) << ", branch-misses " << HardwareCounter(BRANCH_MISSES) << "\n";
+            }
+        }
+    };
+
+    // 워커 스레드마다 한 번만 연다 (열 수 없으면 nullptr, 다시 시도하지 않는다)
+    inline clau_compat::PerfCounters* ThreadCounters() {
+        thread_local clau_compat::PerfCounters counters;
+        thread_local int state = 0;  // 0 : 아직, 1 : 열림, 2 : 실패
+        if (state == 0) state = counters.Open() ? 1 : 2;
+        return state == 1 ? &counters : nullptr;
+    }
+
+    // stage 1 워커 한 명의 계측 : 만들 때 카운터를 읽어 두고, 없어질 때 차이를 워커 칸에 더한다.
+    // stats 가 nullptr 이면 아무것도 하지 않는다. workers 는 미리 워커 수만큼 잡혀 있어야 한다
+    class WorkerProbe {
+    public:
+        WorkerProbe(LoadStats* stats, int w) {
+            if (!stats) return;
+            slot = &stats->workers[w];
+            if (stats->hardware_counters) {
+                counters = ThreadCounters();
+                if (counters && !counters->Read(begin)) counters = nullptr;
+            }
+        }
+        WorkerProbe(const WorkerProbe&) = delete;
+        WorkerProbe& operator=(const WorkerProbe&) = delete;
+        ~WorkerProbe() {
+            int64_t end[LoadStats::COUNTER_NUM];
+            if (!counters || !counters->Read(end)) return;
+            for (int c = 0; c < LoadStats::COUNTER_NUM; ++c) slot->counters[c] += end[c] - begin[c];
+            slot->counted = true;
+        }
+
+        // 청크 하나를 끝냈다 (started : 시작할 때의 LoadStats::Clock)
+        void Chunk(int64_t bytes, int64_t tokens, int64_t started) {
+            if (!slot) return;
+            slot->bytes += bytes;
+            slot->tokens += tokens;
+            slot->chunks += 1;
+            slot->busy_ns += LoadStats::Now() - started;
+        }
+
+    private:
+        LoadStats::Worker* slot = nullptr;
+        clau_compat::PerfCounters* counters = nullptr;
+        int64_t begin[LoadStats::COUNTER_NUM] = {};
+    };
+
+    // ── 청크별 토큰 아레나 ───────────────────────────────────────────
+    //  토큰 수를 미리 알 수 없으므로 작게 잡고 모자랄 때만 realloc 으로 늘린다 (0 초기화 없음).
+    //  로드 사이에 재사용하며, 해제는 소유자가 Release 로 한다.
+    //  typed 이면 토큰마다 TokenType 한 바이트를 types 에 따로 쓴다 (SoA : data[i] 와 types[i] 가 같은 토큰).
+    //  types 는 nullptr 이거나 capacity 칸이다.
+    template <class TokenT>
+    struct TokenArena {
+        TokenT* data = nullptr;
+        uint8_t* types = nullptr;
+        int64_t capacity = 0;
+        bool failed = false;  // 워커 안에서 확보 실패 (워커에서는 throw 하지 않는다)
+        bool fixed = false;   // 남의 버퍼 일부를 빌려 씀 : 토큰 수를 미리 알고 있어 늘리지 않는다
+        bool bad_utf8 = false;  // 마지막 스캔에서 잘못된 UTF-8 을 만남 (검증한 스캔만 갱신)
+        bool typed = false;     // 토큰 종류 배열도 채운다
+        int node = -1;          // NUMA 배치 : 마지막으로 이 아레나를 둔 노드 (모르면 -1)
+
+        bool Reserve(int64_t need) {
+            if (need <= capacity && (types || !typed)) return true;
+            if (fixed) return false;
+            const int64_t cap = need <= capacity ? capacity : std::max(need, capacity + capacity / 2);
+            void* p = realloc(data, static_cast<size_t>(cap) * sizeof(TokenT));
+            if (!p) return false;
+            data = static_cast<TokenT*>(p);
+            if (typed) {
+                void* q = realloc(types, static_cast<size_t>(cap));
+                if (!q) return false;
+                types = static_cast<uint8_t*>(q);
+            }
+            else {
+                free(types);
+                types = nullptr;
+            }
+            capacity = cap;
+            return true;
+        }
+
+        // 내용을 옮기지 않고 need 칸 이상으로 (모자랄 때만 다시 잡는다. 0 초기화 없음)
+        bool Renew(int64_t need) {
+            if (need <= capacity && (types || !typed)) return true;
+            free(data);
+            free(types);
+            data = static_cast<TokenT*>(malloc(static_cast<size_t>(need) * sizeof(TokenT)));
+            types = typed ? static_cast<uint8_t*>(malloc(static_cast<size_t>(need))) : nullptr;
+            capacity = need;
+            if (data && (types || !typed)) return true;
+            Release();
+            return false;
+        }
+
+        void Release() {
+            free(data);
+            free(types);
+            data = nullptr;
+            types = nullptr;
+            capacity = 0;
+            failed = false;
+            bad_utf8 = false;
+            node = -1;
+        }
+    };
+
+
+    // ── 테이프 (구조 파싱 결과) ──────────────────────────────────────
+    //  값 하나당 64비트 한 칸 : 상위 8비트 = TokenType, 하위 56비트 = payload
+    //   LEFT_BRACE / LEFT_BRACKET   : 짝이 되는 닫힘 칸 다음 인덱스 (→ 하위 트리를 한 번에 건너뜀)
+    //   RIGHT_BRACE / RIGHT_BRACKET : 여는 칸 인덱스
+    //   STRING / NUMBER / TRUE / FALSE / _NULL : 입력 안의 토큰 오프셋
+    //     (문자열은 여는 따옴표, 나머지는 word 첫 바이트. 값은 읽을 때 해석한다)
+    //  객체 안에서는 키(STRING)와 값이 번갈아 나온다. ':' ',' 는 테이프에 없다.
+    //  최상위 값이 여러 개면 차례로 놓인다.
+    class Tape {
+    public:
+        static constexpr int TYPE_SHIFT = 56;
+        static constexpr uint64_t PAYLOAD_MASK = (uint64_t(1) << TYPE_SHIFT) - 1;
+
+        static __forceinline uint64_t Make(TokenType type, uint64_t payload) {
+            return (static_cast<uint64_t>(type) << TYPE_SHIFT) | payload;
+        }
+        static __forceinline TokenType TypeOf(uint64_t word) { return static_cast<TokenType>(word >> TYPE_SHIFT); }
+        static __forceinline uint64_t PayloadOf(uint64_t word) { return word & PAYLOAD_MASK; }
+
+        Tape() = default;
+        Tape(const Tape&) = delete;
+        Tape& operator=(const Tape&) = delete;
+        ~Tape() { free(words); }
+
+        const uint64_t* Data() const { return words; }
+        int64_t Size() const { return size; }
+        TokenType Type(int64_t i) const { return TypeOf(words[i]); }
+        uint64_t Payload(int64_t i) const { return PayloadOf(words[i]); }
+
+        // i 번째 값 다음 값의 인덱스 (컨테이너면 하위 트리 전체를 건너뛴다)
+        int64_t Next(int64_t i) const {
+            const TokenType type = Type(i);
+            return type == TokenType::LEFT_BRACE || type == TokenType::LEFT_BRACKET
+                ? static_cast<int64_t>(Payload(i)) : i + 1;
+        }
+
+        // 다음 파싱까지 유지되는 버퍼를 돌려준다
+        void Release() {
+            free(words);
+            words = nullptr;
+            size = capacity = 0;
+        }
+
+        // 빌더용 : 크기를 정하고 (모자랄 때만 다시 잡음, 0 초기화 없음) 쓰기 포인터를 준다
+        uint64_t* Resize(int64_t n) {
+            if (n > capacity) {
+                void* p = realloc(words, static_cast<size_t>(std::max<int64_t>(n, 1)) * sizeof(uint64_t));
+                if (!p) return nullptr;
+                words = static_cast<uint64_t*>(p);
+                capacity = n;
+            }
+            size = n;
+            return words;
+        }
+
+    private:
+        uint64_t* words = nullptr;
+        int64_t size = 0;
+        int64_t capacity = 0;
+    };
+
+
+    // ── 괄호 짝 인덱스 ──────────────────────────────────────────────
+    //  토큰 번호 → 짝이 되는 괄호의 토큰 번호. 토큰 배열과 같은 길이이며
+    //  괄호가 아닌 토큰 자리의 값은 정해져 있지 않다.
+    //  여는 괄호 t 의 하위 트리는 토큰 (t, Match(t)) 이므로, 다음 값은 Match(t) + 1 부터 찾는다.
+    template <class TokenT>
+    class BasicBracketIndex {
+    public:
+        BasicBracketIndex() = default;
+        BasicBracketIndex(const BasicBracketIndex&) = delete;
+        BasicBracketIndex& operator=(const BasicBracketIndex&) = delete;
+        ~BasicBracketIndex() { free(match); }
+
+        int64_t Match(int64_t token) const { return static_cast<int64_t>(match[token]); }
+        const TokenT* Data() const { return match; }
+        int64_t Size() const { return size; }
+
+        void Release() {
+            free(match);
+            match = nullptr;
+            size = capacity = 0;
+        }
+
+        // 빌더용 : 크기를 정하고 (모자랄 때만 다시 잡음, 0 초기화 없음) 쓰기 포인터를 준다
+        TokenT* Resize(int64_t n) {
+            if (n > capacity) {
+                void* p = realloc(match, static_cast<size_t>(std::max<int64_t>(n, 1)) * sizeof(TokenT));
+                if (!p) return nullptr;
+                match = static_cast<TokenT*>(p);
+                capacity = n;
+            }
+            size = n;
+            return match;
+        }
+
+    private:
+        TokenT* match = nullptr;
+        int64_t size = 0;
+        int64_t capacity = 0;
+    };
+
+
+    // ── 스칼라 값 배열 ───────────────────────────────────────────────
+    //  토큰 번호 → 그 토큰의 ScalarKind 와 값 (kinds 1바이트 + values 8바이트, 토큰 배열과 같은 길이).
+    //  values 는 INT64 / DOUBLE 일 때만 의미가 있다.
+    class ScalarValues {
+    public:
+        ScalarValues() = default;
+        ScalarValues(const ScalarValues&) = delete;
+        ScalarValues& operator=(const ScalarValues&) = delete;
+        ~ScalarValues() { Release(); }
+
+        ScalarKind Kind(int64_t token) const { return static_cast<ScalarKind>(kinds[token]); }
+        ScalarValue Value(int64_t token) const { return values[token]; }
+        int64_t Size() const { return size; }
+
+        // 처음 나온 INVALID 토큰 번호 (없으면 -1)
+        int64_t FirstInvalid() const { return first_invalid; }
+
+        void Release() {
+            free(kinds);
+            free(values);
+            kinds = nullptr;
+            values = nullptr;
+            size = capacity = 0;
+            first_invalid = -1;
+        }
+
+        // 빌더용 : 크기를 정한다 (모자랄 때만 다시 잡음, 0 초기화 없음)
+        bool Resize(int64_t n) {
+            if (n > capacity) {
+                const size_t count = static_cast<size_t>(std::max<int64_t>(n, 1));
+                void* k = realloc(kinds, count * sizeof(uint8_t));
+                if (k) kinds = static_cast<uint8_t*>(k);
+                void* v = realloc(values, count * sizeof(ScalarValue));
+                if (v) values = static_cast<ScalarValue*>(v);
+                if (!k || !v) return false;
+                capacity = n;
+            }
+            size = n;
+            first_invalid = -1;
+            return true;
+        }
+
+        uint8_t* KindData() { return kinds; }
+        ScalarValue* ValueData() { return values; }
+        void SetFirstInvalid(int64_t token) { first_invalid = token; }
+
+    private:
+        uint8_t* kinds = nullptr;
+        ScalarValue* values = nullptr;
+        int64_t size = 0;
+        int64_t capacity = 0;
+        int64_t first_invalid = -1;
+    };
+
+
+    // ── 레코드 인덱스 (JSON Lines) ───────────────────────────────────
+    //  레코드 번호 → 그 레코드(한 줄의 최상위 값)의 첫 토큰 번호.
+    //  레코드 r 의 토큰은 [First(r), First(r + 1)) 이고 First(Size()) == 토큰 수 (센티넬).
+    //  토큰이 없는 줄(빈 줄)은 레코드가 아니다.
+    class RecordIndex {
+    public:
+        RecordIndex() = default;
+        RecordIndex(const RecordIndex&) = delete;
+        RecordIndex& operator=(const RecordIndex&) = delete;
+        ~RecordIndex() { free(first); }
+
+        int64_t First(int64_t record) const { return first[record]; }
+        const int64_t* Data() const { return first; }
+        int64_t Size() const { return size; }
+
+        void Release() {
+            free(first);
+            first = nullptr;
+            size = capacity = 0;
+        }
+
+        // 빌더용 : 레코드 수를 정하고 (센티넬 칸 포함, 모자랄 때만 다시 잡음, 0 초기화 없음) 쓰기 포인터를 준다
+        int64_t* Resize(int64_t n) {
+            if (n + 1 > capacity) {
+                void* p = realloc(first, static_cast<size_t>(n + 1) * sizeof(int64_t));
+                if (!p) return nullptr;
+                first = static_cast<int64_t*>(p);
+                capacity = n + 1;
+            }
+            size = n;
+            return first;
+        }
+
+    private:
+        int64_t* first = nullptr;
+        int64_t size = 0;
+        int64_t capacity = 0;
+    };
+
+
+    // ── 문자열 아레나 ───────────────────────────────────────────────
+    //  escape 를 풀어 쓴 문자열을 담는다. 블록 단위로 늘리므로 이미 돌려준 문자열은 움직이지 않는다.
+    //  Reset 은 블록을 남긴 채 비우기만 한다 (다음 로드에서 재사용). 스레드 안전하지 않다.
+    class StringArena {
+    public:
+        static constexpr int64_t kBlockSize = int64_t(1) << 16;
+
+        StringArena() = default;
+        ~StringArena() { Release(); }
+        StringArena(const StringArena&) = delete;
+        StringArena& operator=(const StringArena&) = delete;
+
+        // n 바이트를 쓸 자리 (메모리 부족이면 nullptr). 실제로 쓴 끝을 Commit 으로 알린다
+        char* Begin(int64_t n) {
+            while (current < blocks.size() && blocks[current].size - used < n) {
+                ++current;
+                used = 0;
+            }
+            if (current == blocks.size()) {
+                const int64_t size = std::max(n, kBlockSize);
+                char* data = static_cast<char*>(malloc(static_cast<size_t>(size)));
+                if (!data) return nullptr;
+                blocks.push_back({ data, size });
+                used = 0;
+            }
+            return blocks[current].data + used;
+        }
+
+        void Commit(const char* end) { used = end - blocks[current].data; }
+
+        // 담긴 문자열을 모두 무효로 하고 처음부터 다시 쓴다
+        void Reset() {
+            current = 0;
+            used = 0;
+        }
+
+        void Release() {
+            for (auto& block : blocks) free(block.data);
+            blocks.clear();
+            Reset();
+        }
+
+        // 지금까지 잡은 블록 크기 합
+        int64_t Capacity() const {
+            int64_t n = 0;
+            for (const auto& block : blocks) n += block.size;
+            return n;
+        }
+
+    private:
+        struct Block {
+            char* data;
+            int64_t size;
+        };
+        std::vector<Block> blocks;
+        size_t current = 0;
+        int64_t used = 0;
+    };
+
+
+    // ── 문자열 해석 (escape → UTF-8) ─────────────────────────────────
+    //  입력은 따옴표 안 원문. 역슬래시가 없으면 원문을 그대로 돌려준다 (복사 없음).
+    //  있으면 다음 역슬래시까지 SIMD 로 복사(저장 먼저, 위치는 movemask 로)하고 escape 하나를 푸는 것을 반복한다.
+    //  \" \\ \/ \b \f \n \r \t \uXXXX 와 surrogate 쌍을 지원한다.
+    //  짝 없는 surrogate, 모르는 escape, 16진수가 아닌 \u 는 실패 (false).
+    //  풀어 쓴 길이는 원문보다 길지 않으므로 (원문 + kSlack) 만 잡으면 된다.
+    class StringDecoder {
+    public:
+        static constexpr int64_t kSlack = 32;  // SIMD 저장이 문자열 끝을 넘어 쓰는 만큼
+
+        static bool Decode(std::string_view raw, StringArena& arena, std::string_view& out) {
+            const char* p = raw.data();
+            const char* end = p + raw.size();
+            char* none = nullptr;
+            const char* bs = Best() ? UntilBackslashAvx2<false>(p, end, none) : UntilBackslashSse<false>(p, end, none);
+            if (bs == end) { out = raw; return true; }
+
+            char* dst = arena.Begin(static_cast<int64_t>(raw.size()) + kSlack);
+            if (!dst) return false;
+            memcpy(dst, p, static_cast<size_t>(bs - p));
+            char* w = Unescape(bs, end, dst + (bs - p));
+            if (!w) return false;
+            arena.Commit(w);
+            out = std::string_view(dst, static_cast<size_t>(w - dst));
+            return true;
+        }
+
+        static bool Decode(std::string_view raw, std::string& out) {
+            out.resize(raw.size() + kSlack);
+            char* w = Unescape(raw.data(), raw.data() + raw.size(), &out[0]);
+            out.resize(w ? static_cast<size_t>(w - out.data()) : 0);
+            return w != nullptr;
+        }
+
+        // 풀어 쓴 값이 text 와 같은가 (쓰지 않고 비교)
+        static bool Equals(std::string_view raw, std::string_view text) {
+            const char* p = raw.data();
+            const char* end = p + raw.size();
+            size_t j = 0;
+            while (p < end) {
+                if (*p != '\\') {
+                    if (j >= text.size() || text[j++] != *p++) return false;
+                    continue;
+                }
+                char buf[4];
+                const int n = Escape(p, end, buf);
+                if (n == 0 || text.size() - j < static_cast<size_t>(n) || memcmp(text.data() + j, buf, n) != 0) return false;
+                j += n;
+            }
+            return j == text.size();
+        }
+
+    private:
+        static bool Best() {
+            static const bool avx2 = CpuFeatures::Best() >= SimdLevel::AVX2;
+            return avx2;
+        }
+
+        // [p, end) 를 escape 하나씩 풀며 dst 에 쓴다. p 는 역슬래시 위치여도 된다. 반환은 쓴 끝
+        static char* Unescape(const char* p, const char* end, char* dst) {
+            const bool avx2 = Best();
+            while (true) {
+                p = avx2 ? UntilBackslashAvx2<true>(p, end, dst) : UntilBackslashSse<true>(p, end, dst);
+                if (p == end) return dst;
+                const int n = Escape(p, end, dst);
+                if (n == 0) return nullptr;
+                dst += n;
+            }
+        }
+
+        // p 의 escape 하나를 풀어 dst 에 쓰고 (1~4 바이트) p 를 넘긴다. 잘못됐으면 0
+        static __forceinline int Escape(const char*& p, const char* end, char* dst) {
+            if (end - p < 2) return 0;
+            switch (p[1]) {
+            case '"':  *dst = '"';  p += 2; return 1;
+            case '\\': *dst = '\\'; p += 2; return 1;
+            case '/':  *dst = '/';  p += 2; return 1;
+            case 'b':  *dst = '\b'; p += 2; return 1;
+            case 'f':  *dst = '\f'; p += 2; return 1;
+            case 'n':  *dst = '\n'; p += 2; return 1;
+            case 'r':  *dst = '\r'; p += 2; return 1;
+            case 't':  *dst = '\t'; p += 2; return 1;
+            case 'u':  break;
+            default:   return 0;
+            }
+
+            uint32_t cp = Hex4(p + 2, end);
+            if (cp > 0xFFFF) return 0;
+            p += 6;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {  // 상위 surrogate : 바로 뒤에 \uDC00~DFFF 가 와야 한다
+                if (end - p < 2 || p[0] != '\\' || p[1] != 'u') return 0;
+                const uint32_t low = Hex4(p + 2, end);
+                if (low < 0xDC00 || low > 0xDFFF) return 0;
+                p += 6;
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+            }
+            else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                return 0;
+            }
+            return EncodeUtf8(cp, dst);
+        }
+
+        // 16진수 네 자리 (모자라거나 16진수가 아니면 0xFFFF 보다 큰 값)
+        static __forceinline uint32_t Hex4(const char* p, const char* end) {
+            if (end - p < 4) return ~0u;
+            uint32_t v = 0;
+            for (int k = 0; k < 4; ++k) {
+                const char c = p[k];
+                uint32_t d;
+                if (c >= '0' && c <= '9') d = static_cast<uint32_t>(c - '0');
+                else if (c >= 'a' && c <= 'f') d = static_cast<uint32_t>(c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') d = static_cast<uint32_t>(c - 'A' + 10);
+                else return ~0u;
+                v = (v << 4) | d;
+            }
+            return v;
+        }
+
+        static __forceinline int EncodeUtf8(uint32_t cp, char* dst) {
+            if (cp < 0x80) {
+                dst[0] = static_cast<char>(cp);
+                return 1;
+            }
+            if (cp < 0x800) {
+                dst[0] = static_cast<char>(0xC0 | (cp >> 6));
+                dst[1] = static_cast<char>(0x80 | (cp & 0x3F));
+                return 2;
+            }
+            if (cp < 0x10000) {
+                dst[0] = static_cast<char>(0xE0 | (cp >> 12));
+                dst[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                dst[2] = static_cast<char>(0x80 | (cp & 0x3F));
+                return 3;
+            }
+            dst[0] = static_cast<char>(0xF0 | (cp >> 18));
+            dst[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            dst[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            dst[3] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 4;
+        }
+
+        // 다음 역슬래시 (없으면 end). kCopy 면 지나온 바이트를 dst 에 쓰고 dst 를 넘긴다.
+        // 블록을 먼저 저장하고 역슬래시 위치만큼만 dst 를 움직인다 (dst 는 kSlack 여유 필요)
+        template <bool kCopy>
+        static __forceinline const char* UntilBackslashSse(const char* p, const char* end, char*& dst) {
+            const __m128i bs = _mm_set1_epi8('\\');
+            for (; end - p >= 16; p += 16) {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                if constexpr (kCopy) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+                const uint32_t m = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, bs)));
+                if (m != 0) {
+                    const int k = clau_compat::ctz64(m);
+                    if constexpr (kCopy) dst += k;
+                    return p + k;
+                }
+                if constexpr (kCopy) dst += 16;
+            }
+            for (; p < end && *p != '\\'; ++p)
+                if constexpr (kCopy) *dst++ = *p;
+            return p;
+        }
+
+        template <bool kCopy>
+        CLAU_TARGET_AVX2 static const char* UntilBackslashAvx2(const char* p, const char* end, char*& dst) {
+            const __m256i bs = _mm256_set1_epi8('\\');
+            for (; end - p >= 32; p += 32) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                if constexpr (kCopy) _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+                const uint32_t m = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, bs)));
+                if (m != 0) {
+                    const int k = clau_compat::ctz64(m);
+                    if constexpr (kCopy) dst += k;
+                    return p + k;
+                }
+                if constexpr (kCopy) dst += 32;
+            }
+            return UntilBackslashSse<kCopy>(p, end, dst);
+        }
+    };
+
+
+    // ── 커서 (DOM 없이 토큰 배열 위에서 탐색) ─────────────────────────
+    //  값 하나 = 그 값의 첫 토큰 번호. 값은 꺼낼 때만 해석하고, 아무것도 따로 만들지 않는다.
+    //  값의 원문 끝은 다음 토큰 위치에서 공백을 걷어낸 곳이다 (tokens[token_len] == 입력 길이 센티넬).
+    //  괄호 짝 인덱스가 있으면 하위 트리를 O(1) 로 건너뛰고, 없으면 깊이를 세며 지나간다.
+    //  스칼라 값 배열이 있으면 숫자는 거기서 읽고, 없으면 꺼낼 때 NumberParser 로 해석한다.
+    //  문자열과 키는 escape 를 풀어 돌려준다. escape 가 없으면 원문 그대로, 있으면 문자열 아레나에 쓴다.
+    //  토큰 종류 배열이 있으면 토큰 종류를 거기서 읽고, 없으면 입력의 첫 바이트로 정한다.
+    //  찾지 못했거나 타입이 다르면 Valid() == false 인 커서 / false 를 돌려준다 (예외 없음).
+    //  입력, 토큰, 인덱스는 커서보다 오래 살아 있어야 한다 (보통 다음 로드 전까지).
+    template <class TokenT>
+    class BasicCursor {
+    public:
+        BasicCursor() = default;
+        BasicCursor(const char* text, int64_t length, const TokenT* tokens, int64_t token_len,
+            const BasicBracketIndex<TokenT>* index = nullptr, const ScalarValues* scalars = nullptr,
+            StringArena* strings = nullptr, const uint8_t* types = nullptr, int64_t token = 0)
+            : text(text), length(length), tokens(tokens), token_len(token_len),
+            index(index && index->Size() == token_len ? index : nullptr),
+            scalars(scalars && scalars->Size() == token_len ? scalars : nullptr), strings(strings), types(types),
+            token(token) {}
+
+        bool Valid() const { return token >= 0 && token < token_len; }
+        int64_t GetToken() const { return token; }
+
+        // LEFT_BRACE(객체), LEFT_BRACKET(배열), STRING, NUMBER, TRUE, FALSE, _NULL. 무효면 END
+        TokenType Type() const { return Valid() ? TypeAt(token) : TokenType::END; }
+        bool IsObject() const { return Type() == TokenType::LEFT_BRACE; }
+        bool IsArray() const { return Type() == TokenType::LEFT_BRACKET; }
+        bool IsString() const { return Type() == TokenType::STRING; }
+        bool IsNumber() const { return Type() == TokenType::NUMBER; }
+        bool IsNull() const { return Type() == TokenType::_NULL && Raw() == "null"; }
+
+        // ── 탐색 ──
+        //  객체의 key 멤버 값. escape 가 있는 키는 풀어서 비교한다 (아레나에 쓰지 않음)
+        BasicCursor Field(std::string_view key) const {
+            if (!IsObject()) return Invalid();
+            for (int64_t t = token + 1; t < token_len && TypeAt(t) == TokenType::STRING; ) {
+                const int64_t value = t + 2;
+                if (value >= token_len || TypeAt(t + 1) != TokenType::ASSIGNMENT) break;
+                if (KeyEquals(StringAt(t), key)) return At(value);
+                t = End(value) + 1;
+                if (t >= token_len || TypeAt(t) != TokenType::COMMA) break;
+                ++t;
+            }
+            return Invalid();
+        }
+
+        // 배열의 i 번째 원소
+        BasicCursor Element(int64_t i) const {
+            if (!IsArray() || i < 0) return Invalid();
+            BasicCursor x = First();
+            for (; x.Valid() && i > 0; --i) x = x.Next();
+            return x;
+        }
+
+        BasicCursor operator[](std::string_view key) const { return Field(key); }
+        BasicCursor operator[](int64_t i) const { return Element(i); }
+
+        // RFC 6901 JSON Pointer ("" = 자기 자신, "/a/0/b~1c")
+        BasicCursor Pointer(std::string_view pointer) const {
+            BasicCursor x = *this;
+            std::string decoded;
+            while (!pointer.empty()) {
+                if (pointer[0] != '/' || !x.Valid()) return Invalid();
+                pointer.remove_prefix(1);
+                const size_t slash = pointer.find('/');
+                std::string_view ref = pointer.substr(0, slash);
+                pointer = slash == std::string_view::npos ? std::string_view() : pointer.substr(slash);
+
+                if (ref.find('~') != std::string_view::npos) {  // ~1 → '/', ~0 → '~'
+                    decoded.clear();
+                    for (size_t k = 0; k < ref.size(); ++k) {
+                        if (ref[k] != '~') { decoded.push_back(ref[k]); continue; }
+                        if (k + 1 >= ref.size() || (ref[k + 1] != '0' && ref[k + 1] != '1')) return Invalid();
+                        decoded.push_back(ref[++k] == '0' ? '~' : '/');
+                    }
+                    ref = decoded;
+                }
+
+                if (x.IsArray()) {
+                    int64_t i = 0;
+                    if (ref.empty() || (ref.size() > 1 && ref[0] == '0')) return Invalid();
+                    const auto r = std::from_chars(ref.data(), ref.data() + ref.size(), i);
+                    if (r.ec != std::errc() || r.ptr != ref.data() + ref.size()) return Invalid();
+                    x = x.Element(i);
+                }
+                else {
+                    x = x.Field(ref);
+                }
+            }
+            return x;
+        }
+
+        // ── 순회 ──
+        //  컨테이너의 첫 원소 (객체면 첫 멤버의 값). 비었으면 무효
+        BasicCursor First() const {
+            const TokenType type = Type();
+            if (type != TokenType::LEFT_BRACE && type != TokenType::LEFT_BRACKET) return Invalid();
+            const int64_t t = token + 1;
+            if (t >= token_len) return Invalid();
+            const TokenType next = TypeAt(t);
+            if (next == TokenType::RIGHT_BRACE || next == TokenType::RIGHT_BRACKET) return Invalid();
+            if (type == TokenType::LEFT_BRACE)
+                return t + 2 < token_len && TypeAt(t + 1) == TokenType::ASSIGNMENT ? At(t + 2) : Invalid();
+            return At(t);
+        }
+
+        // 같은 컨테이너 안의 다음 원소 (마지막이면 무효). 최상위 값이 여러 개면 다음 최상위 값
+        BasicCursor Next() const {
+            if (!Valid()) return Invalid();
+            int64_t t = End(token) + 1;
+            if (t >= token_len) return Invalid();
+            const TokenType next = TypeAt(t);
+            if (next == TokenType::RIGHT_BRACE || next == TokenType::RIGHT_BRACKET) return Invalid();
+            if (next == TokenType::COMMA) ++t;
+            if (t >= token_len) return Invalid();
+            if (HasKey()) return t + 2 < token_len && TypeAt(t + 1) == TokenType::ASSIGNMENT ? At(t + 2) : Invalid();
+            return At(t);
+        }
+
+        // 원소 / 멤버 수 (원소 수만큼 건너뛴다)
+        int64_t Count() const {
+            int64_t n = 0;
+            for (BasicCursor x = First(); x.Valid(); x = x.Next()) ++n;
+            return n;
+        }
+
+        // 객체 멤버의 값이면 그 키 (escape 를 푼 값. GetString 과 같은 규칙)
+        bool Key(std::string_view& out) const {
+            return HasKey() && Decode(StringAt(token - 2), out);
+        }
+
+        bool GetRawKey(std::string_view& out) const {
+            if (!HasKey()) return false;
+            out = StringAt(token - 2);
+            return true;
+        }
+
+        // ── 값 ──
+        //  문자열 : escape 를 푼 UTF-8. escape 가 없으면 원문 그대로 (복사 없음), 있으면 문자열 아레나에 쓴다.
+        //  잘못된 escape 이거나, escape 가 있는데 아레나가 없으면 false (std::string 판을 쓴다)
+        bool GetString(std::string_view& out) const {
+            return IsString() && Decode(StringAt(token), out);
+        }
+
+        bool GetString(std::string& out) const {
+            return IsString() && StringDecoder::Decode(StringAt(token), out);
+        }
+
+        //  따옴표 안 원문 (escape 그대로)
+        bool GetRawString(std::string_view& out) const {
+            if (!IsString()) return false;
+            out = StringAt(token);
+            return true;
+        }
+
+        //  숫자 : GetInt64 는 정수가 int64 에 들어갈 때만, GetDouble 은 모든 숫자
+        bool GetInt64(int64_t& out) const {
+            ScalarValue value;
+            if (Scalar(value) != ScalarKind::INT64) return false;
+            out = value.i;
+            return true;
+        }
+
+        bool GetDouble(double& out) const {
+            ScalarValue value;
+            switch (Scalar(value)) {
+            case ScalarKind::INT64:  out = static_cast<double>(value.i); return true;
+            case ScalarKind::DOUBLE: out = value.d; return true;
+            default:                 return false;
+            }
+        }
+
+        bool GetUint64(uint64_t& out) const { return IsNumber() && Parse(Raw(), out); }
+
+        bool GetBool(bool& out) const {
+            const std::string_view raw = Raw();
+            if (raw == "true") { out = true; return true; }
+            if (raw == "false") { out = false; return true; }
+            return false;
+        }
+
+        // 값의 원문. 문자열은 따옴표 포함, 컨테이너는 여는 괄호부터 닫는 괄호까지
+        std::string_view Raw() const {
+            if (!Valid()) return {};
+            const int64_t first = static_cast<int64_t>(tokens[token]);
+            const int64_t last = End(token);
+            const TokenType type = Type();
+            if (type == TokenType::LEFT_BRACE || type == TokenType::LEFT_BRACKET)
+                return std::string_view(text + first, static_cast<size_t>(static_cast<int64_t>(tokens[last]) + 1 - first));
+            return std::string_view(text + first, static_cast<size_t>(TrimmedEnd(token) - first));
+        }
+
+    private:
+        const char* text = nullptr;
+        int64_t length = 0;
+        const TokenT* tokens = nullptr;
+        int64_t token_len = 0;
+        const BasicBracketIndex<TokenT>* index = nullptr;
+        const ScalarValues* scalars = nullptr;
+        StringArena* strings = nullptr;
+        const uint8_t* types = nullptr;
+        int64_t token = -1;
+
+        TokenType TypeAt(int64_t t) const {
+            return static_cast<TokenType>(types ? types[t] : char_to_token_type[static_cast<uint8_t>(text[tokens[t]])]);
+        }
+        BasicCursor At(int64_t t) const { return BasicCursor(text, length, tokens, token_len, index, scalars, strings, types, t); }
+
+        bool Decode(std::string_view raw, std::string_view& out) const {
+            if (strings) return StringDecoder::Decode(raw, *strings, out);
+            if (memchr(raw.data(), '\\', raw.size())) return false;
+            out = raw;
+            return true;
+        }
+
+        // escape 하나는 적어도 한 바이트를 줄이므로, 길이가 같으면 escape 없이 같아야 한다
+        static bool KeyEquals(std::string_view raw, std::string_view key) {
+            if (raw.size() == key.size()) return raw == key && !memchr(raw.data(), '\\', raw.size());
+            return raw.size() > key.size() && memchr(raw.data(), '\\', raw.size()) && StringDecoder::Equals(raw, key);
+        }
+
+        ScalarKind Scalar(ScalarValue& value) const {
+            if (!Valid() || TypeAt(token) == TokenType::STRING) return ScalarKind::NONE;
+            if (scalars) {
+                value = scalars->Value(token);
+                return scalars->Kind(token);
+            }
+            const std::string_view raw = Raw();
+            return NumberParser::Classify(raw.data(), raw.data() + raw.size(), value);
+        }
+        BasicCursor Invalid() const { return At(-1); }
+
+        // 값이 객체 멤버인가 ("key" : 값)
+        bool HasKey() const { return Valid() && token >= 2 && TypeAt(token - 1) == TokenType::ASSIGNMENT; }
+
+        // t 에서 시작한 값의 마지막 토큰 (컨테이너면 닫는 괄호)
+        int64_t End(int64_t t) const {
+            const TokenType type = TypeAt(t);
+            if (type != TokenType::LEFT_BRACE && type != TokenType::LEFT_BRACKET) return t;
+            if (index) return index->Match(t);
+            int64_t depth = 0;
+            for (int64_t u = t; u < token_len; ++u) {
+                switch (TypeAt(u)) {
+                case TokenType::LEFT_BRACE: case TokenType::LEFT_BRACKET:
+                    ++depth;
+                    break;
+                case TokenType::RIGHT_BRACE: case TokenType::RIGHT_BRACKET:
+                    if (--depth == 0) return u;
+                    break;
+                default:
+                    break;
+                }
+            }
+            return token_len - 1;  // 닫히지 않음
+        }
+
+        // 토큰 t 원문의 끝 (다음 토큰 앞의 공백 제외)
+        int64_t TrimmedEnd(int64_t t) const {
+            return Utility::TokenEnd(text, static_cast<int64_t>(tokens[t]), static_cast<int64_t>(tokens[t + 1]));
+        }
+
+        // 문자열 토큰 t 의 따옴표 안 원문
+        std::string_view StringAt(int64_t t) const {
+            const int64_t first = static_cast<int64_t>(tokens[t]) + 1;
+            int64_t last = TrimmedEnd(t);
+            if (last > first && text[last - 1] == '"') --last;
+            return std::string_view(text + first, static_cast<size_t>(std::max<int64_t>(last - first, 0)));
+        }
+
+        template <class T>
+        static bool Parse(std::string_view raw, T& out) {
+            const auto r = std::from_chars(raw.data(), raw.data() + raw.size(), out);
+            return r.ec == std::errc() && r.ptr == raw.data() + raw.size();
+        }
+    };
+
+
+    // ── 파일 로드 + 병렬 스캔 (TokenT : 토큰 오프셋 타입) ───────────────
+    template <class TokenT>
+    class BasicInFileReserver {
+    public:
+        using Token = TokenT;
+        using BracketIndex = BasicBracketIndex<TokenT>;
+
+    private:
+        char* buffer = nullptr;            // InputMode::READ 용 버퍼
+        int64_t buffer_len = 0;            // buffer 크기
+        clau_compat::MappedFile mapping;   // InputMode::MMAP 용 매핑
+        const char* text = nullptr;        // 이번 로드의 입력 (BOM 제외)
+        int64_t text_len = 0;
+        int64_t text_bom = 0;              // READ 로 읽은 파일의 BOM 길이
+        std::vector<TokenArena<Token>> arenas;  // 청크별 토큰 (스캔 결과 조각)
+        TokenArena<Token> token_dense;          // 연속 배열 (typed 이면 종류 배열도)
+        mutable StringArena strings;       // 이번 로드에서 escape 를 풀어 쓴 문자열
+
+    public:
+        ~BasicInFileReserver() {
+            delete[] buffer;
+            for (auto& arena : arenas) arena.Release();
+            token_dense.Release();
+        }
+
+    private:
+        BasicInFileReserver(const BasicInFileReserver&) = delete;
+        BasicInFileReserver& operator=(const BasicInFileReserver&) = delete;
+
+        // ── Stage 1 공통: 64바이트 블록 마스크 → 토큰 ──────────────────────
+        //  문자열 내부 영역을 stage 1 에서 바로 계산하므로 최종 토큰만 기록된다.
+        //  - 구조문자({ } [ ] : ,) : 문자열 밖에 있는 것만
+        //  - 문자열 : 여는 따옴표 위치 하나
+        //  - 그 외 값(숫자/true/false/null) : word 의 첫 바이트
+        //  블록 사이 carry: 홀수 역슬래시 run, 문자열 내부 여부, word 진행 여부
+        //  kUtf8 이면 같은 블록을 Utf8Check* 로 검증한다 (블록 사이 carry 는 검사기 안에)
+        struct Stage1State {
+            uint64_t prev_escaped = 0;    // 0/1 : 다음 블록 0번 바이트가 escape 됨
+            uint64_t prev_in_string = 0;  // 0/~0
+            uint64_t prev_scalar = 0;     // 0/1 : 직전 바이트가 word 에 속함
+            int64_t token_count = 0;
+        };
+
+        // 홀수 길이 역슬래시 run 뒤의 따옴표를 걸러낸 '진짜' 따옴표 마스크 (simdjson find_escaped)
+        static __forceinline uint64_t RealQuotes(const BlockMasks64& m, Stage1State& st) {
+            constexpr uint64_t even_bits = 0x5555555555555555ULL;
+
+            const uint64_t backslash = m.backslash & ~st.prev_escaped;
+            const uint64_t follows_escape = (backslash << 1) | st.prev_escaped;
+            const uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+            const uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+            st.prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts; // carry
+            const uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+            const uint64_t escaped = (even_bits ^ invert_mask) & follows_escape;
+
+            return m.quote & ~escaped;
+        }
+
+        //  kCountOnly : 토큰을 쓰지 않고 개수만 센다 (count-then-fill 의 첫 단계)
+        //  type_arr   : nullptr 가 아니면 토큰 첫 바이트(p[k])의 종류도 같은 자리에 쓴다
+        template <bool kCountOnly>
+        static __forceinline void EmitBlock(const BlockMasks64& m, uint64_t quote, uint64_t quote_prefix,
+            const char* p, int64_t i, int64_t num, Token* token_arr, uint8_t* type_arr, Stage1State& st)
+        {
+            const uint64_t in_string = quote_prefix ^ st.prev_in_string;
+            st.prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+            const uint64_t scalar = ~(m.whitespace | m.op | quote | in_string);
+            const uint64_t scalar_start = scalar & ~((scalar << 1) | st.prev_scalar);
+            st.prev_scalar = scalar >> 63;
+
+            uint64_t mask = (m.op & ~in_string) | (quote & in_string) | scalar_start;
+            if constexpr (kCountOnly) {
+                st.token_count += clau_compat::popcount64(mask);
+                return;
+            }
+            if (type_arr) {
+                while (mask != 0) {
+                    const int k = clau_compat::ctz64(mask);
+                    type_arr[st.token_count] = char_to_token_type[static_cast<uint8_t>(p[k])];
+                    token_arr[st.token_count++] = Utility::Get<Token>(i + k + num, 1, nullptr);
+                    mask &= mask - 1;
+                }
+                return;
+            }
+            while (mask != 0) {
+                token_arr[st.token_count++] = Utility::Get<Token>(i + clau_compat::ctz64(mask) + num, 1, nullptr);
+                mask &= mask - 1;
+            }
+        }
+
+        // 64바이트 미만 꼬리: 공백으로 채운 복사본을 같은 규칙으로 처리 (over-read 없음)
+        template <class ScanBlock>
+        static __forceinline void ScanTail(const char* text, int64_t i, int64_t length, ScanBlock scan_block)
+        {
+            if (i < length) {
+                alignas(64) char tail[64];
+                memset(tail, ' ', sizeof(tail));
+                memcpy(tail, text + i, static_cast<size_t>(length - i));
+                scan_block(tail, i);
+            }
+        }
+
+        // 블록 단위 구동: 64바이트 블록 하나가 만드는 토큰은 최대 64개이므로
+        // 블록마다 (64 + 센티넬 1) 칸이 남아 있는지만 확인하고, 모자라면 아레나를 늘린다.
+        // 개수만 세거나(kCountOnly) 크기가 정해진 버퍼(arena.fixed)에 쓸 때는 확인하지 않는다.
+        // 늘릴 때마다 토큰 / 종류 포인터를 다시 읽는다. 확보 실패 시 arena.failed 를 세우고 false.
+        template <bool kCountOnly, class ScanBlock>
+        static __forceinline bool ScanBlocks(const char* text, int64_t length,
+            TokenArena<Token>& arena, Token*& token_arr, uint8_t*& type_arr, const Stage1State& st, ScanBlock scan_block)
+        {
+            const bool grow = !kCountOnly && !arena.fixed;
+            auto reserve = [&](int64_t need) {
+                if (!arena.Reserve(need)) { arena.failed = true; return false; }
+                token_arr = arena.data;
+                type_arr = arena.typed ? arena.types : nullptr;
+                return true;
+            };
+            if (grow && arena.typed && !arena.types && !reserve(std::max<int64_t>(arena.capacity, 65))) return false;
+            for (int64_t i = 0; i < length; i += 64) {
+                if (grow && st.token_count + 65 > arena.capacity && !reserve(st.token_count + 65)) return false;
+                if (i + 64 <= length) scan_block(text + i, i);
+                else ScanTail(text, i, length, scan_block);
+            }
+            return !grow || reserve(st.token_count + 1);  // 빈 청크의 센티넬
+        }
+
+        // ── Stage 1: AVX2 ─────────────────────────────────────────────
+        //  arena     : 청크의 토큰 저장소 (필요하면 늘어난다)
+        //  in_string : 청크가 문자열 안에서 시작하는가
+        //  반환값    : 청크 끝에서 문자열 안인가
+        template <bool kCountOnly, bool kUtf8>
+        CLAU_TARGET_AVX2 static bool ScanWithSimdJsonStyle(const char* text, int64_t num, int64_t length,
+            TokenArena<Token>& arena, int64_t& token_arr_size, bool in_string)
+        {
+            Stage1State st;
+            st.prev_in_string = in_string ? ~uint64_t(0) : 0;
+            Token* token_arr = arena.data;
+            uint8_t* type_arr = arena.typed ? arena.types : nullptr;
+            Utf8CheckAvx2 utf8;
+            if constexpr (kUtf8) utf8.Reset();
+
+            auto scan_block = [&](const char* p, int64_t i) CLAU_TARGET_AVX2 {
+                if constexpr (kUtf8) utf8.Block(p);
+                const BlockMasks64 m = get_block_masks64_avx2(p);
+                const uint64_t quote = RealQuotes(m, st);
+                EmitBlock<kCountOnly>(m, quote, prefix_xor_clmul(quote), p, i, num, token_arr, type_arr, st);
+                };
+
+            if (!ScanBlocks<kCountOnly>(text, length, arena, token_arr, type_arr, st, scan_block)) { token_arr_size = 0; return false; }
+            if constexpr (kUtf8) arena.bad_utf8 = utf8.Failed();
+
+            token_arr_size = st.token_count;
+            return st.prev_in_string != 0;
+        }
+
+        // ── Stage 1 (AVX-512BW 경로) ──────────────────────────────────
+        template <bool kCountOnly, bool kUtf8>
+        CLAU_TARGET_AVX512 static bool ScanWithAvx512(const char* text, int64_t num, int64_t length,
+            TokenArena<Token>& arena, int64_t& token_arr_size, bool in_string)
+        {
+            Stage1State st;
+            st.prev_in_string = in_string ? ~uint64_t(0) : 0;
+            Token* token_arr = arena.data;
+            uint8_t* type_arr = arena.typed ? arena.types : nullptr;
+            Utf8CheckAvx512 utf8;
+            if constexpr (kUtf8) utf8.Reset();
+
+            auto scan_block = [&](const char* p, int64_t i) CLAU_TARGET_AVX512 {
+                if constexpr (kUtf8) utf8.Block(p);
+                const BlockMasks64 m = get_block_masks64_avx512(p);
+                const uint64_t quote = RealQuotes(m, st);
+                EmitBlock<kCountOnly>(m, quote, prefix_xor_clmul(quote), p, i, num, token_arr, type_arr, st);
+                };
+
+            if (!ScanBlocks<kCountOnly>(text, length, arena, token_arr, type_arr, st, scan_block)) { token_arr_size = 0; return false; }
+            if constexpr (kUtf8) arena.bad_utf8 = utf8.Failed();
+
+            token_arr_size = st.token_count;
+            return st.prev_in_string != 0;
+        }
+
+        // ── Stage 1 (SSE4.2 경로) ──────────────────────────────────────
+        //  PCLMULQDQ 없는 CPU 도 이 경로를 타므로 prefix XOR 은 시프트로 계산
+        template <bool kCountOnly, bool kUtf8>
+        CLAU_TARGET_SSE42 static bool _Scanning_SIMD(const char* text, int64_t num, int64_t length,
+            TokenArena<Token>& arena, int64_t& token_arr_size, bool in_string)
+        {
+            Stage1State st;
+            st.prev_in_string = in_string ? ~uint64_t(0) : 0;
+            Token* token_arr = arena.data;
+            uint8_t* type_arr = arena.typed ? arena.types : nullptr;
+            Utf8CheckSse utf8;
+            if constexpr (kUtf8) utf8.Reset();
+
+            auto scan_block = [&](const char* p, int64_t i) CLAU_TARGET_SSE42 {
+                if constexpr (kUtf8) utf8.Block(p);
+                const BlockMasks64 m = get_block_masks64_sse(p);
+                const uint64_t quote = RealQuotes(m, st);
+                EmitBlock<kCountOnly>(m, quote, prefix_xor(quote), p, i, num, token_arr, type_arr, st);
+                };
+
+            if (!ScanBlocks<kCountOnly>(text, length, arena, token_arr, type_arr, st, scan_block)) { token_arr_size = 0; return false; }
+            if constexpr (kUtf8) arena.bad_utf8 = utf8.Failed();
+
+            token_arr_size = st.token_count;
+            return st.prev_in_string != 0;
+        }
+
+        // ── Stage 1 (스칼라 경로) ──────────────────────────────────────
+        //  SIMD 커널과 같은 규칙을 바이트 단위 상태 기계로 처리
+        template <bool kCountOnly, bool kUtf8>
+        static bool _Scanning(const char* text, int64_t num, const int64_t length,
+            TokenArena<Token>& arena, int64_t& token_arr_size, bool in_string)
+        {
+            int64_t token_arr_count = 0;
+            bool escape_next = false;
+            bool prev_scalar = false;
+            Token* token_arr = arena.data;
+            uint8_t* type_arr = arena.typed ? arena.types : nullptr;
+            const bool grow = !kCountOnly && !arena.fixed;
+            Utf8Validator utf8;
+
+            auto emit = [&](int64_t i) {
+                if constexpr (kCountOnly) ++token_arr_count;
+                else {
+                    if (type_arr) type_arr[token_arr_count] = char_to_token_type[static_cast<uint8_t>(text[i])];
+                    token_arr[token_arr_count++] = Utility::Get<Token>(i + num, 1, text + i);
+                }
+                };
+
+            for (int64_t i = 0; i < length; ++i) {
+                // SIMD 커널과 같이 64바이트마다 (64 + 센티넬 1) 칸 확인
+                if (grow && (i & 63) == 0 && (token_arr_count + 65 > arena.capacity || (arena.typed && !type_arr))) {
+                    if (!arena.Reserve(token_arr_count + 65)) { arena.failed = true; token_arr_size = 0; return false; }
+                    token_arr = arena.data;
+                    type_arr = arena.typed ? arena.types : nullptr;
+                }
+
+                const char ch = text[i];
+                if constexpr (kUtf8) utf8.Step(static_cast<unsigned char>(ch));
+                const bool escaped = escape_next;
+                escape_next = (ch == '\\') && !escaped;
+
+                if (in_string) {
+                    if (ch == '"' && !escaped) in_string = false;
+                    continue;
+                }
+
+                switch (ch) {
+                case ' ': case '\t': case '\r': case '\n':
+                    prev_scalar = false;
+                    break;
+
+                case LoadDataOption::LeftBrace:  case LoadDataOption::LeftBracket:
+                case LoadDataOption::RightBrace: case LoadDataOption::RightBracket:
+                case LoadDataOption::Assignment: case LoadDataOption::Comma:
+                    emit(i);
+                    prev_scalar = false;
+                    break;
+
+                case '"':
+                    if (!escaped) {
+                        emit(i);
+                        in_string = true;
+                        prev_scalar = false;
+                        break;
+                    }
+                    [[fallthrough]];
+
+                default:
+                    if (!prev_scalar) emit(i);
+                    prev_scalar = true;
+                    break;
+                }
+            }
+
+            if (grow && !arena.Reserve(token_arr_count + 1)) { arena.failed = true; token_arr_size = 0; return false; }
+            if constexpr (kUtf8) arena.bad_utf8 = utf8.Failed();
+
+            token_arr_size = token_arr_count;
+            return in_string;
+        }
+
+        // ── Stage 1 커널 선택 ─────────────────────────────────────────
+        using ScanKernel = bool (*)(const char*, int64_t, int64_t, TokenArena<Token>&, int64_t&, bool);
+
+        //  kUtf8 : 같은 블록 루프에서 UTF-8 도 검증해 arena.bad_utf8 에 남긴다.
+        //          검증은 문자열 상태와 무관하므로 청크마다 첫 스캔에서만 하면 된다.
+        template <bool kCountOnly = false, bool kUtf8 = false>
+        static ScanKernel SelectKernel(SimdLevel level) {
+            switch (CpuFeatures::Clamp(level)) {
+            case SimdLevel::AVX512: return ScanWithAvx512<kCountOnly, kUtf8>;
+            case SimdLevel::AVX2:   return ScanWithSimdJsonStyle<kCountOnly, kUtf8>;
+            case SimdLevel::SSE42:  return _Scanning_SIMD<kCountOnly, kUtf8>;
+            default:                return _Scanning<kCountOnly, kUtf8>;
+            }
+        }
+
+        template <bool kCountOnly = false>
+        static ScanKernel SelectKernel(SimdLevel level, bool validate_utf8) {
+            return validate_utf8 ? SelectKernel<kCountOnly, true>(level) : SelectKernel<kCountOnly, false>(level);
+        }
+
+        // 청크 시작이 문자열 안인지 추측 (Pison 식 문맥 추측).
+        // 첫 따옴표 뒤에 ':' ',' '}' ']' 가 오면 닫는 따옴표로 본다.
+        // 틀려도 prefix 검증 후 재스캔되므로 결과에는 영향이 없고 속도에만 영향이 있다.
+        static bool GuessInString(const char* text, int64_t length) {
+            const int64_t limit = std::min<int64_t>(length, 4096);
+            for (int64_t x = 0; x < limit; ++x) {
+                if (text[x] == '\\') { ++x; continue; }
+                if (text[x] != '"') continue;
+
+                for (int64_t y = x + 1; y < length; ++y) {
+                    switch (text[y]) {
+                    case ' ': case '\t': case '\r': case '\n':
+                        continue;
+                    case LoadDataOption::Assignment: case LoadDataOption::Comma:
+                    case LoadDataOption::RightBrace: case LoadDataOption::RightBracket:
+                        return true;
+                    default:
+                        return false;
+                    }
+                }
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        // ── 청크 크기 정책 ─────────────────────────────────────────────
+        //  스레드 수보다 훨씬 많이 잘라서, 토큰 밀도가 다른 구간이 한 스레드에 몰리지 않게 한다.
+        //  numa : 청크의 텍스트(READ)와 토큰 아레나를 그 청크를 스캔하는 워커의 NUMA 노드에 둔다 (SetNumaPlacement)
+        struct ChunkPolicy {
+            int     chunks_per_thread = 8;
+            int64_t min_chunk_size = int64_t(64) << 10;
+            bool    numa = false;
+        };
+
+        // ── 청크 하나 스캔 (입력을 직접 잘라 넣는 스트리밍용) ─────────────
+        //  text 는 분할 가능 위치에서 시작해야 한다 (스트림 처음이거나 LastSplitPoint 로 자른 자리).
+        //  토큰은 text 안의 오프셋으로 arena 에 쓰이고, arena 는 필요하면 늘어난다 (실패 시 arena.failed).
+        //  in_string : text 시작이 문자열 안인가. 반환값은 text 끝 상태.
+        //  UTF-8 도 같이 검증한다 : 잘못됐으면 arena.bad_utf8 (위치는 Utf8Validator::FirstInvalid 로)
+        static bool ScanChunk(const char* text, int64_t length, bool in_string,
+            TokenArena<Token>& arena, int64_t& token_len, SimdLevel level)
+        {
+            arena.failed = false;
+            arena.Reserve(length / 8 + 65);
+            return SelectKernel<false, true>(level)(text, 0, length, arena, token_len, in_string);
+        }
+
+        // 시작 상태를 모를 때의 추측. 틀렸으면 올바른 상태로 ScanChunk 를 다시 부른다
+        static bool GuessChunkState(const char* text, int64_t length) { return GuessInString(text, length); }
+
+        // text[0, length) 안의 마지막 분할 가능 위치 (없으면 0). 그 뒤는 다음 청크로 넘긴다.
+        // lines : JSON Lines 입력이면 줄바꿈 자리에서만 자른다 (레코드가 청크 사이에 걸치지 않는다)
+        static int64_t LastSplitPoint(const char* text, int64_t length, bool lines = false) {
+            for (int64_t x = length - 1; x >= 1; --x)
+                if (IsSplitPoint(text, x, lines)) return x;
+            return 0;
+        }
+
+    private:
+        // x (0 < x < length) 에서 청크를 나눌 수 있는가 : JSON 공백이나 구조문자이고,
+        // 역슬래시 바로 뒤가 아니어야 한다 (→ 청크 사이 escape carry 불필요)
+        static __forceinline bool IsSplitPoint(const char* text, int64_t x) {
+            if (text[x - 1] == '\\') return false;
+            switch (text[x]) {
+            case ' ': case '\t': case '\r': case '\n':
+            case LoadDataOption::LeftBrace:  case LoadDataOption::LeftBracket:
+            case LoadDataOption::RightBrace: case LoadDataOption::RightBracket:
+            case LoadDataOption::Assignment: case LoadDataOption::Comma:
+                return true;
+            }
+            return false;
+        }
+
+        // JSON Lines : 줄바꿈 자리에서만 나눈다. 올바른 입력이면 문자열 안에 날 줄바꿈이 없으므로
+        // 청크 시작은 언제나 문자열 밖이다 → 추측할 필요가 없다 (틀린 입력이어도 FixGuesses 가 바로잡는다)
+        static __forceinline bool IsSplitPoint(const char* text, int64_t x, bool lines) {
+            return lines ? text[x] == '\n' : IsSplitPoint(text, x);
+        }
+
+        // 나눌 청크 수 (경계가 겹쳐 줄어들기 전)
+        static int64_t ChunkCount(int64_t length, int thr_num, const ChunkPolicy& policy) {
+            const int64_t chunk_num = static_cast<int64_t>(thr_num) * std::max(policy.chunks_per_thread, 1);
+            return std::max<int64_t>(1, std::min(chunk_num, length / std::max<int64_t>(policy.min_chunk_size, 1)));
+        }
+
+        // 청크 경계 계산
+        static void SplitChunks(const char* text, int64_t length, int thr_num, const ChunkPolicy& policy, bool lines,
+            std::vector<int64_t>& start, std::vector<int64_t>& last)
+        {
+            int64_t chunk_num = ChunkCount(length, thr_num, policy);
+
+            start.assign(chunk_num, 0);
+            last.assign(chunk_num, 0);
+
+            start[0] = 0;
+            for (int64_t i = 1; i < chunk_num; ++i) {
+                start[i] = length / chunk_num * i;
+                for (int64_t x = start[i]; x <= length; ++x) {
+                    if (x == length) { start[i] = length; break; }
+                    if (IsSplitPoint(text, x, lines)) { start[i] = x; break; }
+                }
+            }
+
+            // 중복 제거
+            {
+                std::set<int64_t> _set(start.begin(), start.end());
+                _set.erase(length);
+                _set.insert(0);
+                chunk_num = static_cast<int64_t>(_set.size());
+                start.clear();
+                for (auto x : _set) start.push_back(x);
+                last.resize(chunk_num);
+            }
+            for (int64_t i = 0; i < chunk_num - 1; ++i) last[i] = start[i + 1];
+            last[chunk_num - 1] = length;
+        }
+
+        // barrier 의 serial 구간에서 호출 : 앞에서부터 실제 시작 상태를 이어 붙여
+        // 추측이 틀린 청크를 redo 에 모으고 guess 를 바로잡는다. 반환값은 텍스트 끝 상태.
+        //  따옴표 parity 는 시작 상태와 무관하므로 (추측 시작 ^ 추측 끝) 이 곧 청크의 parity.
+        //  state : 텍스트 시작 상태 (파일 처음이면 false, 창 단위 스캔이면 앞 창의 끝 상태)
+        static bool FixGuesses(std::vector<char>& guess, const std::vector<char>& end_state,
+            std::vector<int64_t>& redo, bool state)
+        {
+            for (size_t t = 0; t < guess.size(); ++t) {
+                const bool parity = (guess[t] != 0) != (end_state[t] != 0);
+                if ((guess[t] != 0) != state) {
+                    guess[t] = state;
+                    redo.push_back(static_cast<int64_t>(t));
+                }
+                state = state != parity;
+            }
+            return state;
+        }
+
+        // 첫 스캔에서 잘못된 UTF-8 을 만난 청크 중 가장 앞 청크만 바이트 단위로 다시 훑어 위치를 찾는다.
+        // 청크는 문자 경계에서 시작하므로 청크 처음부터 보면 된다. 없으면 -1
+        static int64_t FindUtf8Error(const char* text, const std::vector<int64_t>& start,
+            const std::vector<int64_t>& last, const std::vector<char>& bad_utf8)
+        {
+            for (size_t t = 0; t < bad_utf8.size(); ++t) {
+                if (!bad_utf8[t]) continue;
+                const int64_t x = Utf8Validator::FirstInvalid(text + start[t], last[t] - start[t]);
+                if (x >= 0) return start[t] + x;
+            }
+            return -1;
+        }
+
+        // NUMA 배치 : 아레나를 지금 스캔하는 워커의 노드로 옮긴다. 처음 잡는 아레나는 이 워커가 처음 쓰므로
+        // first-touch 로 자리가 정해지고, 로드 사이에 재사용하는 아레나는 맡은 워커의 노드가 바뀔 때만 옮긴다
+        static void PlaceArena(TokenArena<Token>& arena) {
+            const int node = clau_compat::current_numa_node();
+            if (node < 0 || node == arena.node) return;
+            if (arena.capacity > 0) {
+                clau_compat::prefer_numa_node(arena.data, arena.capacity * static_cast<int64_t>(sizeof(Token)), node);
+                if (arena.types) clau_compat::prefer_numa_node(arena.types, arena.capacity, node);
+            }
+            arena.node = node;
+        }
+
+        // ── 병렬 스캐닝 메인 (TokenStorage::ARENAS) ─────────────────────
+        //  in_string : 들어올 때 text 시작이 문자열 안인지, 나갈 때 text 끝이 문자열 안인지
+        //  utf8_error : nullptr 가 아니면 첫 스캔에서 UTF-8 도 검증하고, 처음 잘못된 위치(없으면 -1)를 쓴다
+        //  typed      : 아레나마다 토큰 종류 배열도 채운다
+        //  lines      : JSON Lines 입력 (줄바꿈에서만 나누고 청크 시작은 문자열 밖으로 본다)
+        //  stats      : nullptr 가 아니면 단계별 시간과 워커별 몫을 더한다 (workers 는 thr_num 칸 이상)
+        static bool ScanningNew(WorkerPool& pool, const char* text, int64_t length, bool& in_string, int thr_num,
+            std::vector<TokenArena<Token>>& arenas, bool typed, bool lines,
+            std::vector<Token*>& _token_arr, std::vector<int64_t>& _token_arr_sizes, int64_t& _token_arr_size,
+            SimdLevel simd_level, const ChunkPolicy& policy, int64_t* utf8_error, LoadStats* stats)
+        {
+            const ScanKernel first_kernel = SelectKernel(simd_level, utf8_error != nullptr);
+            const ScanKernel kernel = SelectKernel(simd_level);
+
+            std::vector<int64_t> start, last;
+            SplitChunks(text, length, thr_num, policy, lines, start, last);
+            const int64_t chunk_num = static_cast<int64_t>(start.size());
+            thr_num = static_cast<int>(std::min<int64_t>(thr_num, chunk_num));
+
+            // 토큰 저장소 : 청크마다 아레나 하나. 바이트당 토큰 1/8 을 예상해 잡고,
+            // 모자라면 커널이 블록 단위로 늘린다. 이전 로드의 아레나는 그대로 재사용.
+            if (static_cast<int64_t>(arenas.size()) < chunk_num) arenas.resize(chunk_num);
+            for (auto& arena : arenas) { arena.failed = false; arena.typed = typed; }
+
+            std::vector<int64_t> token_arr_size(chunk_num, 0);
+            std::vector<char>    guess(chunk_num, 0);      // 청크 시작 문자열 상태 추측
+            std::vector<char>    end_state(chunk_num, 0);  // 추측 기준 청크 끝 상태
+            std::vector<char>    bad_utf8(chunk_num, 0);
+            std::vector<int64_t> redo;
+
+            // ── Stage 1 (추측한 시작 상태로 스캔) → barrier → 틀린 청크만 재스캔 ──
+            //  두 단계 모두 청크를 work stealing 으로 나눠 가진다.
+            const int64_t a = LoadStats::Clock(stats);
+            int64_t b = a;
+            const bool start_state = in_string;
+
+            StealingScheduler sched;
+            sched.Reset(chunk_num, thr_num);
+
+            pool.Run(thr_num, [&](int w) {
+                WorkerProbe probe(stats, w);
+                int64_t i;
+                while (sched.Next(w, i)) {
+                    const int64_t started = LoadStats::Clock(stats);
+                    if (policy.numa) PlaceArena(arenas[i]);
+                    arenas[i].Reserve((last[i] - start[i]) / 8 + 65);  // 실패하면 커널이 다시 시도 후 failed
+                    guess[i] = i > 0 ? !lines && GuessInString(text + start[i], last[i] - start[i]) : start_state;
+                    end_state[i] = first_kernel(text + start[i], start[i], last[i] - start[i],
+                        arenas[i], token_arr_size[i], guess[i] != 0);
+                    bad_utf8[i] = arenas[i].bad_utf8;
+                    probe.Chunk(last[i] - start[i], token_arr_size[i], started);
+                }
+
+                pool.Barrier([&] {
+                    b = LoadStats::Clock(stats);
+                    in_string = FixGuesses(guess, end_state, redo, start_state);
+                    sched.Reset(static_cast<int64_t>(redo.size()), thr_num);
+                    });
+
+                int64_t k;
+                while (sched.Next(w, k)) {
+                    const int64_t started = LoadStats::Clock(stats);
+                    i = redo[k];
+                    kernel(text + start[i], start[i], last[i] - start[i],
+                        arenas[i], token_arr_size[i], guess[i] != 0);
+                    probe.Chunk(last[i] - start[i], token_arr_size[i], started);
+                }
+                });
+
+            if (stats) {
+                stats->scan_ns += b - a;
+                stats->stitch_ns += LoadStats::Clock(stats) - b;
+                stats->chunks += chunk_num;
+                stats->rescanned += static_cast<int64_t>(redo.size());
+            }
+
+            for (int64_t t = 0; t < chunk_num; ++t)
+                if (arenas[t].failed) return false;
+
+            if (utf8_error) {
+                *utf8_error = FindUtf8Error(text, start, last, bad_utf8);
+                if (*utf8_error >= 0) return false;
+            }
+            return FinishArenas(arenas, chunk_num, length, token_arr_size,
+                _token_arr, _token_arr_sizes, _token_arr_size, stats);
+        }
+
+        // 아레나 스캔 결과 정리 : 조각마다 센티넬(다음 토큰 시작 위치)을 붙이고 조각 목록을 넘긴다
+        static bool FinishArenas(std::vector<TokenArena<Token>>& arenas, int64_t chunk_num, int64_t length,
+            const std::vector<int64_t>& token_arr_size,
+            std::vector<Token*>& _token_arr, std::vector<int64_t>& _token_arr_sizes, int64_t& _token_arr_size,
+            LoadStats* stats)
+        {
+            const int64_t a = LoadStats::Clock(stats);
+            if (stats) {
+                int64_t arena_bytes = 0;
+                for (const auto& arena : arenas)
+                    arena_bytes += arena.capacity * static_cast<int64_t>(sizeof(Token) + (arena.types ? 1 : 0));
+                stats->token_bytes = std::max(stats->token_bytes, arena_bytes);
+            }
+
+            // 센티넬 : 뒤쪽의 비어있지 않은 첫 청크의 첫 토큰
+            std::vector<Token*> tokens(chunk_num);
+            int64_t real_token_arr_count = 0;
+            for (int64_t t = 0; t < chunk_num; ++t) {
+                tokens[t] = arenas[t].data;
+                real_token_arr_count += token_arr_size[t];
+            }
+
+            Token next_start = static_cast<Token>(length);
+            for (int64_t t = chunk_num - 1; t >= 0; --t) {
+                tokens[t][token_arr_size[t]] = next_start;
+                if (token_arr_size[t] > 0) next_start = tokens[t][0];
+            }
+
+            _token_arr = tokens;
+            _token_arr_sizes = token_arr_size;
+            _token_arr_size = real_token_arr_count;
+            if (stats) stats->sentinel_ns += LoadStats::Clock(stats) - a;
+            return true;
+        }
+
+        // ── 청크별 토큰 조각 → 하나의 연속 배열 ──────────────────────────
+        //  청크별 토큰 수의 prefix sum 으로 자리를 정하고, 청크 단위로 병렬 복사.
+        //  결과 끝에는 센티넬(length) 하나만 둔다. 버퍼는 부족할 때만 다시 잡는다 (0 초기화 없음).
+        //  _dense.typed 이면 조각별 종류 배열(type_arr)도 같은 자리로 복사하고 종류 센티넬은 END.
+        static bool CompactTokens(WorkerPool& pool, int thr_num,
+            const std::vector<Token*>& token_arr, const std::vector<int64_t>& token_arr_sizes,
+            const std::vector<const uint8_t*>& type_arr,
+            int64_t length, TokenArena<Token>& _dense, int64_t& _dense_size)
+        {
+            const int64_t chunk_num = static_cast<int64_t>(token_arr.size());
+            std::vector<int64_t> offset(chunk_num + 1, 0);
+            for (int64_t t = 0; t < chunk_num; ++t) offset[t + 1] = offset[t] + token_arr_sizes[t];
+            const int64_t total = offset[chunk_num];
+
+            if (!_dense.Renew(total + 1)) return false;
+
+            Token* dense = _dense.data;
+            uint8_t* types = _dense.typed ? _dense.types : nullptr;
+            thr_num = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(thr_num, chunk_num)));
+            StealingScheduler sched;
+            sched.Reset(chunk_num, thr_num);
+            pool.Run(thr_num, [&](int w) {
+                int64_t t;
+                while (sched.Next(w, t)) {
+                    if (token_arr_sizes[t] <= 0) continue;
+                    memcpy(dense + offset[t], token_arr[t], static_cast<size_t>(token_arr_sizes[t]) * sizeof(Token));
+                    if (types) memcpy(types + offset[t], type_arr[t], static_cast<size_t>(token_arr_sizes[t]));
+                }
+                });
+            dense[total] = static_cast<Token>(length);
+            if (types) types[total] = TokenType::END;
+
+            _dense_size = total;
+            return true;
+        }
+
+        // ── 병렬 스캐닝 (TokenStorage::COUNT_FIRST) ─────────────────────
+        //  1) 개수만 세는 커널(popcount)로 청크별 토큰 수와 끝 상태 → barrier 에서 추측 보정
+        //  2) 틀린 청크만 다시 센다
+        //  3) prefix sum 으로 연속 배열을 정확한 크기로 잡고, 같은 시작 상태로 다시 스캔하며 제자리에 기록 (FillCounted)
+        //  청크별 아레나와 압축 복사가 없으므로 토큰 메모리는 (토큰 수 + 1) 칸뿐이다.
+        //  조각 결과(_token_arr)는 연속 배열 안을 가리키며, 각 조각 뒤가 곧 다음 토큰(센티넬)이다.
+        static bool ScanningCounted(WorkerPool& pool, const char* text, int64_t length, bool& in_string, int thr_num,
+            TokenArena<Token>& _dense, bool lines,
+            std::vector<Token*>& _token_arr, std::vector<int64_t>& _token_arr_sizes, int64_t& _token_arr_size,
+            SimdLevel simd_level, const ChunkPolicy& policy, int64_t* utf8_error, LoadStats* stats)
+        {
+            const ScanKernel first_count_kernel = SelectKernel<true>(simd_level, utf8_error != nullptr);
+            const ScanKernel count_kernel = SelectKernel<true>(simd_level);
+            const ScanKernel kernel = SelectKernel(simd_level);
+
+            std::vector<int64_t> start, last;
+            SplitChunks(text, length, thr_num, policy, lines, start, last);
+            const int64_t chunk_num = static_cast<int64_t>(start.size());
+            thr_num = static_cast<int>(std::min<int64_t>(thr_num, chunk_num));
+
+            std::vector<int64_t> token_arr_size(chunk_num, 0);
+            std::vector<char>    guess(chunk_num, 0);
+            std::vector<char>    end_state(chunk_num, 0);
+            std::vector<char>    bad_utf8(chunk_num, 0);
+            std::vector<int64_t> redo;
+
+            const int64_t a = LoadStats::Clock(stats);
+            int64_t b = a;
+            const bool start_state = in_string;
+
+            StealingScheduler sched;
+            sched.Reset(chunk_num, thr_num);
+
+            pool.Run(thr_num, [&](int w) {
+                WorkerProbe probe(stats, w);
+                TokenArena<Token> none;  // 개수만 셀 때는 쓰지 않는다
+                int64_t i;
+                while (sched.Next(w, i)) {
+                    const int64_t started = LoadStats::Clock(stats);
+                    guess[i] = i > 0 ? !lines && GuessInString(text + start[i], last[i] - start[i]) : start_state;
+                    end_state[i] = first_count_kernel(text + start[i], start[i], last[i] - start[i],
+                        none, token_arr_size[i], guess[i] != 0);
+                    bad_utf8[i] = none.bad_utf8;
+                    probe.Chunk(last[i] - start[i], token_arr_size[i], started);
+                }
+
+                pool.Barrier([&] {
+                    b = LoadStats::Clock(stats);
+                    in_string = FixGuesses(guess, end_state, redo, start_state);
+                    sched.Reset(static_cast<int64_t>(redo.size()), thr_num);
+                    });
+
+                int64_t k;
+                while (sched.Next(w, k)) {
+                    const int64_t started = LoadStats::Clock(stats);
+                    i = redo[k];
+                    count_kernel(text + start[i], start[i], last[i] - start[i],
+                        none, token_arr_size[i], guess[i] != 0);
+                    probe.Chunk(last[i] - start[i], token_arr_size[i], started);
+                }
+                });
+
+            if (stats) {
+                stats->scan_ns += b - a;
+                stats->stitch_ns += LoadStats::Clock(stats) - b;
+                stats->chunks += chunk_num;
+                stats->rescanned += static_cast<int64_t>(redo.size());
+            }
+
+            if (utf8_error) {
+                *utf8_error = FindUtf8Error(text, start, last, bad_utf8);
+                if (*utf8_error >= 0) return false;
+            }
+            return FillCounted(pool, text, length, thr_num, start, last, guess, token_arr_size,
+                kernel, _dense, _token_arr, _token_arr_sizes, _token_arr_size, stats);
+        }
+
+        // COUNT_FIRST 의 기록 단계 : 청크별 개수(올바른 시작 상태 기준)의 prefix sum 으로
+        // 연속 배열을 정확한 크기로 잡고, 같은 시작 상태로 다시 스캔하며 제자리에 기록한다.
+        // _dense.typed 이면 종류 배열도 같은 자리에 바로 쓴다.
+        static bool FillCounted(WorkerPool& pool, const char* text, int64_t length, int thr_num,
+            const std::vector<int64_t>& start, const std::vector<int64_t>& last,
+            const std::vector<char>& guess, const std::vector<int64_t>& token_arr_size, ScanKernel kernel,
+            TokenArena<Token>& _dense,
+            std::vector<Token*>& _token_arr, std::vector<int64_t>& _token_arr_sizes, int64_t& _token_arr_size,
+            LoadStats* stats)
+        {
+            const int64_t chunk_num = static_cast<int64_t>(start.size());
+            thr_num = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(thr_num, chunk_num)));
+
+            std::vector<int64_t> offset(chunk_num + 1, 0);
+            for (int64_t t = 0; t < chunk_num; ++t) offset[t + 1] = offset[t] + token_arr_size[t];
+            if (!_dense.Renew(offset[chunk_num] + 1)) return false;
+
+            const int64_t a = LoadStats::Clock(stats);
+            StealingScheduler sched;
+            sched.Reset(chunk_num, thr_num);
+            pool.Run(thr_num, [&](int w) {
+                int64_t i;
+                while (sched.Next(w, i)) {
+                    TokenArena<Token> slice;
+                    slice.data = _dense.data + offset[i];
+                    slice.types = _dense.typed ? _dense.types + offset[i] : nullptr;
+                    slice.typed = _dense.typed;
+                    slice.capacity = token_arr_size[i];
+                    slice.fixed = true;
+                    int64_t n = 0;
+                    kernel(text + start[i], start[i], last[i] - start[i], slice, n, guess[i] != 0);
+                }
+                });
+            if (stats) {
+                stats->fill_ns += LoadStats::Clock(stats) - a;
+                stats->token_bytes = std::max(stats->token_bytes,
+                    _dense.capacity * static_cast<int64_t>(sizeof(Token) + (_dense.typed ? 1 : 0)));
+            }
+
+            const int64_t total = offset[chunk_num];
+            _dense.data[total] = static_cast<Token>(length);
+            if (_dense.typed) _dense.types[total] = TokenType::END;
+
+            _token_arr.resize(chunk_num);
+            for (int64_t t = 0; t < chunk_num; ++t) _token_arr[t] = _dense.data + offset[t];
+            _token_arr_sizes = token_arr_size;
+            _token_arr_size = total;
+            return true;
+        }
+
+        // ── 읽기와 겹친 병렬 스캐닝 (InputMode::PIPELINED) ────────────────
+        //  파일을 segment_size 단위 세그먼트로 나눠 워커들이 pread 로 채우고,
+        //  청크 k 는 [경계 k, 경계 k+1) 이다. 경계 k 는 k * segment_size 이후 첫 분할 가능 위치라서
+        //  세그먼트 k 와 경계 k+1 을 찾을 만큼의 뒤 세그먼트가 도착하면 바로 스캔할 수 있다.
+        //  워커 한 명이 하는 일 (앞의 것 우선):
+        //   1) 문자열 상태 추측이 틀린 청크 재스캔
+        //   2) 동시 읽기 수가 상한 미만이면 다음 세그먼트 읽기
+        //   3) 다음 청크가 준비됐으면 스캔 (추측한 시작 상태로)
+        //  첫 스캔이 끝난 청크는 앞에서부터 이어 붙이며(frontier) 실제 시작 상태를 확정하고,
+        //  추측이 틀린 청크는 그 자리에서 재스캔 목록에 올린다 → 마지막 세그먼트 직후 바로 끝난다.
+        //  file_offset : 파일 안에서 text[0] 의 위치 (BOM 길이)
+        //  lines : JSON Lines 입력 (경계는 줄바꿈, 추측 없이 문자열 밖에서 시작)
+        static bool ScanningPipelined(WorkerPool& pool, const clau_compat::ReadOnlyFile& file, int64_t file_offset,
+            char* text, int64_t length, int thr_num, const PipelineOptions& options, bool lines,
+            TokenStorage storage, std::vector<TokenArena<Token>>& arenas, TokenArena<Token>& _dense,
+            std::vector<Token*>& _token_arr, std::vector<int64_t>& _token_arr_sizes, int64_t& _token_arr_size,
+            SimdLevel simd_level, int64_t* utf8_error, LoadStats* stats)
+        {
+            const bool count_first = storage == TokenStorage::COUNT_FIRST;
+            const bool validate = utf8_error != nullptr;
+            const ScanKernel first_kernel = count_first ? SelectKernel<true>(simd_level, validate) : SelectKernel(simd_level, validate);
+            const ScanKernel kernel = count_first ? SelectKernel<true>(simd_level) : SelectKernel(simd_level);
+
+            const int64_t seg_size = std::max<int64_t>(options.segment_size, 4096);
+            const int64_t seg_num = std::max<int64_t>(1, (length + seg_size - 1) / seg_size);
+            const int max_inflight = thr_num > 1
+                ? std::max(1, std::min(options.max_inflight_reads, thr_num - 1)) : 1;
+
+            if (!count_first) {
+                if (static_cast<int64_t>(arenas.size()) < seg_num) arenas.resize(seg_num);
+                for (auto& arena : arenas) { arena.failed = false; arena.typed = _dense.typed; }
+            }
+
+            std::unique_ptr<std::atomic<uint8_t>[]> seg_ready(new std::atomic<uint8_t>[seg_num]);
+            std::unique_ptr<std::atomic<uint8_t>[]> scanned(new std::atomic<uint8_t>[seg_num]);
+            std::unique_ptr<std::atomic<int64_t>[]> bound(new std::atomic<int64_t>[seg_num + 1]);
+            for (int64_t k = 0; k < seg_num; ++k) {
+                seg_ready[k].store(0, std::memory_order_relaxed);
+                scanned[k].store(0, std::memory_order_relaxed);
+                bound[k].store(-1, std::memory_order_relaxed);
+            }
+            bound[0].store(0, std::memory_order_relaxed);
+            bound[seg_num].store(length, std::memory_order_relaxed);
+
+            std::vector<int64_t> token_arr_size(seg_num, 0);
+            std::vector<char>    guess(seg_num, 0);
+            std::vector<char>    end_state(seg_num, 0);
+            std::vector<char>    bad_utf8(seg_num, 0);
+            std::vector<int64_t> redo(seg_num, 0);
+
+            std::atomic<int64_t> next_read{ 0 }, inflight{ 0 }, next_scan{ 0 };
+            std::atomic<int64_t> frontier{ 0 }, redo_head{ 0 }, redo_tail{ 0 };
+            std::atomic<bool> io_failed{ false };
+            std::mutex frontier_mutex;
+            bool state = false;  // frontier 위치의 실제 시작 상태 (frontier_mutex)
+
+            auto ready = [&](int64_t k) { return seg_ready[k].load(std::memory_order_acquire) != 0; };
+
+            // 경계 k : 아직 도착하지 않은 세그먼트에 닿으면 -1 (나중에 다시 찾는다)
+            auto find_bound = [&](int64_t k) -> int64_t {
+                int64_t b = bound[k].load(std::memory_order_acquire);
+                if (b >= 0) return b;
+                for (int64_t x = k * seg_size; ; ++x) {
+                    if (x >= length) { b = length; break; }
+                    if (x % seg_size == 0 && !ready(x / seg_size)) return -1;
+                    if (IsSplitPoint(text, x, lines)) { b = x; break; }
+                }
+                bound[k].store(b, std::memory_order_release);
+                return b;
+                };
+
+            // initial : 첫 스캔 (UTF-8 검증 포함) / 재스캔
+            auto scan = [&](WorkerProbe& probe, int64_t k, bool initial) {
+                const int64_t started = LoadStats::Clock(stats);
+                const int64_t first = bound[k].load(std::memory_order_acquire);
+                const int64_t end = bound[k + 1].load(std::memory_order_acquire);
+                TokenArena<Token> none;  // 개수만 셀 때는 쓰지 않는다
+                TokenArena<Token>& out = count_first ? none : arenas[k];
+                if (!count_first) out.Reserve((end - first) / 8 + 65);
+                const bool end_in_string = (initial ? first_kernel : kernel)(text + first, first, end - first,
+                    out, token_arr_size[k], guess[k] != 0);
+                if (initial) bad_utf8[k] = out.bad_utf8;
+                probe.Chunk(end - first, token_arr_size[k], started);
+                return end_in_string;
+                };
+
+            // 첫 스캔이 끝난 청크를 앞에서부터 이어 붙인다. 잠금을 못 잡으면 잡은 쪽이 이어서 처리한다.
+            // try_lock 은 아무도 잡지 않았어도 실패할 수 있으므로 할 일 없는 워커도 frontier 가 뒤처져 있으면 부른다.
+            auto advance = [&] {
+                while (true) {
+                    if (!frontier_mutex.try_lock()) return;
+                    int64_t f = frontier.load();
+                    while (f < seg_num && scanned[f].load()) {
+                        const bool parity = (guess[f] != 0) != (end_state[f] != 0);
+                        if ((guess[f] != 0) != state) {
+                            guess[f] = state;
+                            const int64_t t = redo_tail.load(std::memory_order_relaxed);
+                            redo[t] = f;
+                            redo_tail.store(t + 1, std::memory_order_release);
+                        }
+                        state = state != parity;
+                        ++f;
+                    }
+                    frontier.store(f);
+                    frontier_mutex.unlock();
+                    if (f >= seg_num || !scanned[f].load()) return;
+                }
+                };
+
+            const int64_t a = LoadStats::Clock(stats);
+            pool.Run(thr_num, [&](int w) {
+                WorkerProbe probe(stats, w);
+                int idle = 0;
+                while (true) {
+                    // 1) 재스캔
+                    int64_t h = redo_head.load();
+                    if (h < redo_tail.load(std::memory_order_acquire)) {
+                        if (redo_head.compare_exchange_strong(h, h + 1)) scan(probe, redo[h], false);
+                        idle = 0;
+                        continue;
+                    }
+
+                    // 2) 읽기
+                    if (next_read.load() < seg_num) {
+                        if (inflight.fetch_add(1) < max_inflight) {
+                            const int64_t k = next_read.fetch_add(1);
+                            if (k < seg_num) {
+                                const int64_t first = k * seg_size;
+                                const int64_t size = std::min(seg_size, length - first);
+                                if (!file.ReadAt(text + first, size, file_offset + first)) io_failed = true;
+                                seg_ready[k].store(1, std::memory_order_release);  // 실패해도 대기는 풀어준다
+                            }
+                            inflight.fetch_sub(1);
+                            idle = 0;
+                            continue;
+                        }
+                        inflight.fetch_sub(1);
+                    }
+
+                    // 3) 첫 스캔
+                    int64_t k = next_scan.load();
+                    if (k < seg_num && ready(k) && find_bound(k) >= 0 && find_bound(k + 1) >= 0) {
+                        if (next_scan.compare_exchange_strong(k, k + 1)) {
+                            const int64_t first = bound[k].load(std::memory_order_acquire);
+                            guess[k] = k > 0 && !lines && GuessInString(text + first, bound[k + 1].load() - first);
+                            end_state[k] = scan(probe, k, true);
+                            scanned[k].store(1);
+                            advance();
+                        }
+                        idle = 0;
+                        continue;
+                    }
+
+                    if (frontier.load() < next_scan.load()) advance();
+
+                    // 끝 : 모든 청크가 이어 붙었고 재스캔할 것이 없다
+                    if (frontier.load() >= seg_num && redo_head.load() >= redo_tail.load()) break;
+
+                    if (++idle < 64) _mm_pause();
+                    else std::this_thread::yield();
+                }
+                });
+            if (stats) {  // 읽기와 첫 스캔, 재스캔이 겹치므로 모두 scan_ns
+                stats->scan_ns += LoadStats::Clock(stats) - a;
+                stats->chunks += seg_num;
+                stats->rescanned += redo_tail.load();
+            }
+
+            if (io_failed) return false;
+            if (!count_first)
+                for (int64_t k = 0; k < seg_num; ++k)
+                    if (arenas[k].failed) return false;
+
+            std::vector<int64_t> start(seg_num), last(seg_num);
+            for (int64_t k = 0; k < seg_num; ++k) {
+                start[k] = bound[k].load();
+                last[k] = bound[k + 1].load();
+            }
+            if (utf8_error) {
+                *utf8_error = FindUtf8Error(text, start, last, bad_utf8);
+                if (*utf8_error >= 0) return false;
+            }
+
+            if (count_first) {
+                return FillCounted(pool, text, length, thr_num, start, last, guess, token_arr_size,
+                    SelectKernel(simd_level), _dense, _token_arr, _token_arr_sizes, _token_arr_size, stats);
+            }
+            return FinishArenas(arenas, seg_num, length, token_arr_size,
+                _token_arr, _token_arr_sizes, _token_arr_size, stats);
+        }
+
+        // ── 단일 스레드 스캐너 (Scanning / Scanning2) ─────────────────
+        static void Scanning(const char* text, const int64_t length,
+            Token*& _token_arr, int64_t& _token_arr_size)
+        {
+            Token* token_arr = static_cast<Token*>(calloc(static_cast<size_t>(length + 1), sizeof(Token)));
+            int64_t token_arr_count = 0;
+            int     state = 0;
+            int64_t token_first = 0;
+            int64_t token_last = -1;
+
+            for (int64_t i = 0; i <= length; ++i) {
+                const char ch = text[i];
 
-    // 구분자 위치를 비트마스크로 뽑아내는 함수 (simdjson stage 1 변형)
-    inline uint32_t get_delimiter_mask_avx2(const __m256i chunk) {
-        __m256i quote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
-        __m256i slash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+                if (state == 0) {
+                    if ('"' == ch) {
+                        token_last = i - 1;
+                        if (token_last - token_first + 1 > 0)
+                            token_arr[token_arr_count++] = Utility::Get<Token>(token_first, token_last - token_first + 1, text);
+                        token_first = i; token_last = i; state = 1;
+                    }
+                    else if (Utility::isWhitespace(ch)) {
+                        token_last = i - 1;
+                        if (token_last - token_first + 1 > 0)
+                            token_arr[token_arr_count++] = Utility::Get<Token>(token_first, token_last - token_first + 1, text);
+                        token_first = token_last = i + 1;
+                    }
+                    else if (LoadDataOption::LeftBrace == ch || LoadDataOption::LeftBracket == ch ||
+                        LoadDataOption::RightBrace == ch || LoadDataOption::RightBracket == ch ||
+                        LoadDataOption::Assignment == ch || LoadDataOption::Comma == ch) {
+                        token_last = i - 1;
+                        if (token_last - token_first + 1 > 0)
+                            token_arr[token_arr_count++] = Utility::Get<Token>(token_first, token_last - token_first + 1, text);
+                        token_arr[token_arr_count++] = Utility::Get<Token>(i, 1, text);
+                        token_first = token_last = i + 1;
+                    }
+                }
+                else if (state == 1) {
+                    if ('\\' == ch) {
+                        state = 2;
+                    }
+                    else if ('"' == ch) {
+                        token_last = i;
+                        token_arr[token_arr_count++] = Utility::Get<Token>(token_first, token_last - token_first + 1, text);
+                        token_first = token_last = i + 1;
+                        state = 0;
+                    }
+                }
+                else if (state == 2) {
+                    state = 1;
+                }
+            }
 
-        __m256i lbrace = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('{'));
-        __m256i rbrace = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('}'));
-        __m256i lbrack = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('['));
-        __m256i rbrack = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(']'));
-        __m256i colon = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':'));
-        __m256i comma = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(','));
+            if (length - 1 - token_first + 1 > 0)
+                token_arr[token_arr_count++] = Utility::Get<Token>(token_first, length - 1 - token_first + 1, text);
 
-        __m256i struct_chars = _mm256_or_si256(
-            _mm256_or_si256(_mm256_or_si256(lbrace, rbrace), _mm256_or_si256(lbrack, rbrack)),
-            _mm256_or_si256(colon, comma)
-        );
+            _token_arr = token_arr;
+            _token_arr_size = token_arr_count;
+        }
 
-        __m256i whitespace = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '));
-        whitespace = _mm256_or_si256(whitespace, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')));
-        whitespace = _mm256_or_si256(whitespace, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r')));
-        whitespace = _mm256_or_si256(whitespace, _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t')));
+        // ── 파일 로드 (InputMode::READ) ────────────────────────────────
+        bool OpenRead(const std::string& fileName) {
+            FILE* inFile = nullptr;
+            CLAU_FOPEN(inFile, fileName.c_str(), "rb");  // Windows / POSIX 공용 fopen
+            if (!inFile) return false;
 
-        __m256i all_delimiters = _mm256_or_si256(
-            _mm256_or_si256(quote, slash),
-            _mm256_or_si256(struct_chars, whitespace)
-        );
+            fseek(inFile, 0, SEEK_END);
+            int64_t file_length = CLAU_FTELL64(inFile);
+            fseek(inFile, 0, SEEK_SET);
 
-        return static_cast<uint32_t>(_mm256_movemask_epi8(all_delimiters));
-    }
+            text_bom = Utility::ReadBom(inFile) == Utility::BomType::UTF_8 ? 3 : 0;
+            file_length -= text_bom;
 
-    using Token = uint32_t;
+            // 오프셋(과 끝 센티넬)이 토큰 타입에 들어가지 않으면 잘린 토큰을 만들지 않고 실패
+            if (!TokenFits<Token>(file_length)) { fclose(inFile); return false; }
 
-    namespace LoadDataOption {
-        constexpr char LeftBrace = '{';
-        constexpr char RightBrace = '}';
-        constexpr char LeftBracket = '[';
-        constexpr char RightBracket = ']';
-        constexpr char Assignment = ':';
-        constexpr char Comma = ',';
-    }
+            if (!buffer || buffer_len < file_length) {
+                delete[] buffer;
+                buffer = new (std::nothrow) char[file_length + 1];
+                buffer_len = buffer ? file_length : 0;
+            }
+            if (!buffer) { fclose(inFile); return false; }
 
-    enum TokenType {
-        LEFT_BRACE, RIGHT_BRACE, LEFT_BRACKET, RIGHT_BRACKET,
-        ASSIGNMENT, COMMA, COLON,
-        BACK_SLUSH, QUOTED,
-        STRING, NUMBER, TRUE, FALSE, _NULL, END
-    };
+            const int64_t a = LoadStats::Clock(stats);
+            const size_t got = fread(buffer, sizeof(char), static_cast<size_t>(file_length), inFile);
+            if (stats) {
+                stats->read_ns += LoadStats::Clock(stats) - a;
+                stats->input_bytes = buffer_len + 1;
+            }
+            fclose(inFile);
+            if (got != static_cast<size_t>(file_length)) return false;  // 길이를 잰 뒤 줄었거나 읽기 오류
+            buffer[file_length] = '\0';
 
+            text = buffer;
+            text_len = file_length;
+            return true;
+        }
 
-    class Utility {
-    private:
-        class BomInfo {
-        public:
-            int64_t bom_size;
-            char seq[5];
-        };
+        // ── 파일 매핑 (InputMode::MMAP) ────────────────────────────────
+        //  복사 없이 매핑을 그대로 입력으로 쓴다. READ 용 버퍼는 돌려준다.
+        bool OpenMapped(const std::string& fileName) {
+            delete[] buffer;
+            buffer = nullptr;
+            buffer_len = 0;
 
-        static const int64_t BOM_COUNT = 1;
-        static const BomInfo bomInfo[1];
+            const int64_t a = LoadStats::Clock(stats);
+            if (!mapping.Open(fileName.c_str(), map_options.populate, map_options.sequential, map_options.huge_pages))
+                return false;
+            if (stats) {
+                stats->read_ns += LoadStats::Clock(stats) - a;
+                stats->input_bytes = mapping.size();
+            }
 
-    public:
-        enum class BomType { UTF_8, ANSI };
+            const int64_t bom = Utility::BomSize(mapping.data(), mapping.size());
+            const int64_t file_length = mapping.size() - bom;
 
-        static BomType ReadBom(FILE* file) {
-            char btBom[5] = { 0 };
-            int64_t readSize = static_cast<int64_t>(fread(btBom, sizeof(char), 5, file));
+            if (!TokenFits<Token>(file_length)) { mapping.Close(); return false; }
 
-            if (0 == readSize) {
-                clearerr(file);
-                fseek(file, 0, SEEK_SET);
-                return BomType::ANSI;
+            text = mapping.data() ? mapping.data() + bom : nullptr;
+            text_len = file_length;
+            return true;
+        }
+
+        // ── NUMA 배치 읽기 (InputMode::READ + ChunkPolicy::numa) ──────────
+        //  stage 1 에서 워커 w 가 자기 몫으로 받을 청크들과 거의 같은 바이트 구간을 워커 w 가 직접 pread 한다
+        //  (청크는 고르게 잘리고 StealingScheduler 가 워커마다 연속 구간을 주므로).
+        //  새로 잡은 버퍼는 이 쓰기가 first-touch 라 고정된 워커의 노드에 놓이고,
+        //  재사용하는 버퍼는 노드가 둘 이상일 때만 읽기 전에 구간을 그 노드로 옮긴다.
+        bool OpenPlaced(const std::string& fileName, int thr_num) {
+            clau_compat::ReadOnlyFile file;
+            if (!file.Open(fileName.c_str())) return false;
+            const int64_t size = file.Size();
+            if (size < 0) return false;
+
+            char head[3] = { 0 };
+            const int64_t head_len = std::min<int64_t>(size, 3);
+            if (head_len > 0 && !file.ReadAt(head, head_len, 0)) return false;
+            const int64_t bom = Utility::BomSize(head, head_len);
+            const int64_t file_length = size - bom;
+
+            if (!TokenFits<Token>(file_length)) return false;
+
+            const bool fresh = !buffer || buffer_len < file_length;
+            if (fresh) {
+                delete[] buffer;
+                buffer = new (std::nothrow) char[file_length + 1];  // 0 초기화 없음 : 페이지는 읽는 워커가 처음 만진다
+                buffer_len = buffer ? file_length : 0;
             }
+            if (!buffer) return false;
 
-            BomInfo stBom = { 0 };
-            BomType type = ReadBom(btBom, readSize, stBom);
+            const bool move = !fresh && NumaNodeCount() > 1;
+            const int workers = static_cast<int>(std::min<int64_t>(thr_num, ChunkCount(file_length, thr_num, chunk_policy)));
+            std::atomic<bool> failed{ false };
+            const int64_t a = LoadStats::Clock(stats);
+            pool.Run(workers, [&](int w) {
+                const int64_t first = file_length * w / workers;
+                const int64_t last = file_length * (w + 1) / workers;
+                if (move) clau_compat::prefer_numa_node(buffer + first, last - first, clau_compat::current_numa_node());
+                if (last > first && !file.ReadAt(buffer + first, last - first, bom + first)) failed = true;
+                });
+            if (stats) {
+                stats->read_ns += LoadStats::Clock(stats) - a;
+                stats->input_bytes = buffer_len + 1;
+            }
+            if (failed) return false;
+            buffer[file_length] = '\0';
 
-            if (type == BomType::ANSI) {
-                clearerr(file);
-                fseek(file, 0, SEEK_SET);
-                return BomType::ANSI;
+            text = buffer;
+            text_len = file_length;
+            text_bom = bom;
+            return true;
+        }
+
+        // 허용된 CPU 들이 걸친 NUMA 노드 수 (처음 물을 때 한 번 센다)
+        int NumaNodeCount() {
+            if (numa_nodes == 0) {
+                std::set<int> nodes;
+                for (int cpu : clau_compat::allowed_cpus()) nodes.insert(clau_compat::numa_node_of(cpu));
+                numa_nodes = std::max<int>(1, static_cast<int>(nodes.size()));
             }
+            return numa_nodes;
+        }
 
-            clearerr(file);
-            fseek(file, static_cast<long>(stBom.bom_size * sizeof(char)), SEEK_SET);
-            return type;
+        // 이번 로드의 입력을 준비 : text / text_len 이 파일 내용(BOM 제외)을 가리킨다
+        bool Open(const std::string& fileName, int thr_num) {
+            text = nullptr;
+            text_len = 0;
+            mapping.Close();
+            if (input_mode == InputMode::MMAP) return OpenMapped(fileName);
+            return chunk_policy.numa ? OpenPlaced(fileName, thr_num) : OpenRead(fileName);
         }
 
-        static BomType ReadBom(const char* contents, int64_t length, BomInfo& outInfo) {
-            char btBom[5] = { 0 };
-            int64_t testLength = length < 5 ? length : 5;
-            memcpy(btBom, contents, static_cast<size_t>(testLength));
+        // ── 파일 로드 + 스캔 (InputMode::PIPELINED) ─────────────────────
+        //  버퍼는 READ 와 같이 파일 크기만큼 잡지만, 읽기가 끝나기를 기다리지 않고 스캔한다.
+        bool LoadPipelined(const std::string& fileName, int thr_num, SimdLevel level,
+            std::vector<Token*>& token_arr, std::vector<int64_t>& token_arr_sizes, int64_t& token_arr_len)
+        {
+            text = nullptr;
+            text_len = 0;
+            mapping.Close();
 
-            for (int64_t i = 0; i < BOM_COUNT; ++i) {
-                const BomInfo& bom = bomInfo[i];
-                if (bom.bom_size > testLength) continue;
+            clau_compat::ReadOnlyFile file;
+            if (!file.Open(fileName.c_str())) return false;
+            const int64_t size = file.Size();
+            if (size < 0) return false;
 
-                bool matched = true;
-                for (int64_t j = 0; j < bom.bom_size; ++j) {
-                    if (bom.seq[j] != btBom[j]) { matched = false; break; }
-                }
-                if (!matched) continue;
+            char head[3] = { 0 };
+            const int64_t head_len = std::min<int64_t>(size, 3);
+            if (head_len > 0 && !file.ReadAt(head, head_len, 0)) return false;
+            const int64_t bom = Utility::BomSize(head, head_len);
+            const int64_t file_length = size - bom;
 
-                outInfo = bom;
-                return static_cast<BomType>(i);
+            if (!TokenFits<Token>(file_length)) return false;
+
+            if (!buffer || buffer_len < file_length) {
+                delete[] buffer;
+                buffer = new (std::nothrow) char[file_length + 1];
+                buffer_len = buffer ? file_length : 0;
             }
-            return BomType::ANSI;
+            if (!buffer) return false;
+
+            if (token_storage == TokenStorage::COUNT_FIRST) {
+                for (auto& arena : arenas) arena.Release();
+                arenas.clear();
+            }
+
+            if (stats) {
+                stats->input_bytes = buffer_len + 1;
+                stats->bytes += file_length;
+                stats->workers.resize(std::max<size_t>(stats->workers.size(), static_cast<size_t>(thr_num)));
+            }
+            const bool ok = ScanningPipelined(pool, file, bom, buffer, file_length, thr_num, pipeline_options, json_lines,
+                token_storage, arenas, token_dense,
+                token_arr, token_arr_sizes, token_arr_len, level, validate_utf8 ? &utf8_error : nullptr, stats);
+            if (stats) stats->tokens += token_arr_len;
+            buffer[file_length] = '\0';
+
+            text = buffer;
+            text_len = file_length;
+            return ok;
         }
 
-    public:
-        static __forceinline bool isWhitespace(const char ch) {
-            switch (ch) {
-            case ' ': case '\t': case '\r': case '\n': case '\v': case '\f':
+        // 스캔 결과를 하나의 연속 배열로 (COUNT_FIRST 는 이미 연속 배열)
+        // ARENAS 의 조각 i 는 arenas[i] 이므로 종류 배열 조각도 거기서 가져온다
+        bool Densify(int thr_num, const std::vector<Token*>& token_arr, const std::vector<int64_t>& token_arr_sizes,
+            int64_t token_arr_len, int64_t length, const Token*& tokens, int64_t& token_len)
+        {
+            if (token_storage == TokenStorage::COUNT_FIRST) {
+                tokens = token_dense.data;
+                token_len = token_arr_len;
                 return true;
             }
-            return false;
+            const int64_t a = LoadStats::Clock(stats);
+            std::vector<const uint8_t*> type_arr;
+            if (token_dense.typed)
+                for (size_t t = 0; t < token_arr.size(); ++t) type_arr.push_back(arenas[t].types);
+            if (!CompactTokens(pool, thr_num, token_arr, token_arr_sizes, type_arr, length,
+                token_dense, token_len)) return false;
+            tokens = token_dense.data;
+            if (stats) {
+                stats->sentinel_ns += LoadStats::Clock(stats) - a;
+                stats->dense_bytes = std::max(stats->dense_bytes,
+                    token_dense.capacity * static_cast<int64_t>(sizeof(Token) + (token_dense.typed ? 1 : 0)));
+            }
+            return true;
         }
 
-        static __forceinline int Equal(const int64_t x, const int64_t y) {
-            return (x == y) ? 0 : -1;
+        // 입력 방식에 맞춰 로드하고 스캔한다
+        bool Load(const std::string& fileName, int thr_num, SimdLevel level,
+            std::vector<Token*>& token_arr, std::vector<int64_t>& token_arr_sizes, int64_t& token_arr_len)
+        {
+            utf8_error = -1;
+            strings.Reset();
+            if (stats) stats->Reset();
+            appended.valid = false;
+            if (input_mode == InputMode::PIPELINED)
+                return LoadPipelined(fileName, thr_num, level, token_arr, token_arr_sizes, token_arr_len);
+
+            if (!Open(fileName, thr_num)) return false;
+            bool in_string = false;
+            return Scan(pool, text, text_len, in_string, thr_num, json_lines,
+                token_storage, arenas, token_dense,
+                token_arr, token_arr_sizes, token_arr_len, level, chunk_policy,
+                validate_utf8 ? &utf8_error : nullptr, stats);
         }
 
-        static void skipWhitespace(char* buf, int64_t& token_first, int64_t& token_last) {
-            while (token_first <= token_last && isWhitespace(buf[token_first])) token_first++;
-            while (token_first <= token_last && isWhitespace(buf[token_last]))  token_last--;
+        // ── 이어 읽기 (SetIncremental) ──────────────────────────────────
+        //  READ 로 읽은 파일 뒤에 내용이 덧붙기만 했으면 덧붙은 바이트만 읽고, 기억해 둔 resume 부터 다시 스캔해
+        //  연속 배열 뒤에 잇는다. 로드가 끝날 때 기억하는 것 :
+        //   - 파일 (경로, 장치 / 파일 번호, 수정 시각), BOM 길이, 읽은 길이, 토큰 수
+        //   - resume : 입력의 마지막 분할 가능 위치. 역슬래시 바로 뒤도 word 중간도 아니므로 escape / word 상태를
+        //     넘길 필요가 없다 (ScanWindows 의 창 경계와 같다). 그 앞의 토큰 resume_tokens 개는 뒤에 무엇이 붙어도 같다
+        //   - in_string : resume 가 문자열 안인가 (깊이는 스캔에 필요 없고, 테이프 / 문법 검증은 연속 배열 전체로 다시 한다)
+        //  다음 로드에서 같은 파일 번호이고, 줄지 않았고, 앞 4KiB 와 읽었던 끝 64KiB 가 버퍼와 같으면 이어 읽는다.
+        //  길이와 수정 시각이 모두 그대로면 읽지 않고 지난 결과를 돌려준다. 아니면 처음부터 다시 읽는다.
+        struct AppendState {
+            bool valid = false;
+            std::string path;
+            clau_compat::FileIdentity identity;
+            int64_t bom = 0;
+            int64_t length = 0;      // 읽은 길이 (BOM 제외)
+            int64_t token_len = 0;
+            int64_t resume = 0;
+            int64_t resume_tokens = 0;
+            bool in_string = false;
+            bool typed = false;      // 기억할 때의 설정 : 바뀌었으면 이어 읽지 않는다
+            bool lines = false;
+            bool validated = false;
+        };
+
+        // resume 가 문자열 안인가 : 문자열 안에서는 토큰이 생기지 않으므로 resume 앞의 마지막 토큰이
+        // 여는 따옴표이고, 그 문자열이 resume 전에 닫히지 않았을 때뿐이다
+        static bool InStringAt(const char* text, const Token* tokens, int64_t keep, int64_t resume) {
+            if (keep == 0) return false;
+            int64_t x = static_cast<int64_t>(tokens[keep - 1]);
+            if (text[x] != '"') return false;
+            for (++x; x < resume; ++x) {
+                if (text[x] == '\\') ++x;
+                else if (text[x] == '"') return false;
+            }
+            return true;
         }
 
-        static __forceinline Token Get(int64_t position, int64_t /*length*/, const char* /*ch*/) {
-            return static_cast<Token>(position);
+        // 이번 로드 (READ, 연속 배열) 를 다음 이어 읽기의 기준으로 기억한다
+        void RememberAppend(const std::string& fileName, const Token* tokens, int64_t token_len) {
+            appended.valid = false;
+            clau_compat::ReadOnlyFile file;
+            if (!file.Open(fileName.c_str()) || !file.Identify(appended.identity)) return;
+            appended.path = fileName;
+            appended.bom = text_bom;
+            appended.length = text_len;
+            appended.token_len = token_len;
+            appended.resume = LastSplitPoint(text, text_len, json_lines);
+            appended.resume_tokens = std::lower_bound(tokens, tokens + token_len, static_cast<Token>(appended.resume)) - tokens;
+            appended.in_string = InStringAt(text, tokens, appended.resume_tokens, appended.resume);
+            appended.typed = token_dense.typed;
+            appended.lines = json_lines;
+            appended.validated = validate_utf8;
+            appended.valid = true;
         }
 
-        static __forceinline TokenType GetType(const char ch) {
-            switch (ch) {
-            case LoadDataOption::LeftBrace:    return TokenType::LEFT_BRACE;
-            case LoadDataOption::RightBrace:   return TokenType::RIGHT_BRACE;
-            case LoadDataOption::LeftBracket:  return TokenType::LEFT_BRACKET;
-            case LoadDataOption::RightBracket: return TokenType::RIGHT_BRACKET;
-            case LoadDataOption::Assignment:   return TokenType::ASSIGNMENT;
-            case LoadDataOption::Comma:        return TokenType::COMMA;
-            case '\\':                         return TokenType::BACK_SLUSH;
-            case '\"':                         return TokenType::QUOTED;
-            default:                           return TokenType::STRING;
-            }
+        // 앞 4KiB 와 읽었던 끝 64KiB 가 지금 파일과 같은가 (BOM 포함)
+        bool SamePrefix(const clau_compat::ReadOnlyFile& file) const {
+            const int64_t bom = appended.bom;
+            const int64_t head = std::min<int64_t>(appended.length, 4 << 10);
+            const int64_t tail = std::min<int64_t>(appended.length, 64 << 10);
+            std::vector<char> check(static_cast<size_t>(bom + std::max(head, tail)));
+            if (!file.ReadAt(check.data(), bom + head, 0)) return false;
+            if (Utility::BomSize(check.data(), bom + head) != bom) return false;
+            if (memcmp(check.data() + bom, text, static_cast<size_t>(head)) != 0) return false;
+            if (tail > 0 && !file.ReadAt(check.data(), tail, bom + appended.length - tail)) return false;
+            return memcmp(check.data(), text + appended.length - tail, static_cast<size_t>(tail)) == 0;
         }
 
-        static void PrintToken(std::ostream& out, const char* buffer, const Token& token) {
-            if (out) {
-                uint32_t len = *((&token) + 1) - token;
-                out << std::string_view(buffer + token, len);
+        // 이어 읽기를 시도한다. false 면 처음부터 읽어야 하고 (아무것도 바꾸지 않았다),
+        // true 면 ok 가 결과다 (실패하면 다음 로드는 처음부터)
+        bool TryAppend(const std::string& fileName, int thr_num, SimdLevel level,
+            const Token*& tokens, int64_t& token_len, bool& ok)
+        {
+            if (!appended.valid || appended.path != fileName || input_mode != InputMode::READ ||
+                appended.typed != token_dense.typed || appended.lines != json_lines || appended.validated != validate_utf8 ||
+                text != buffer || !buffer) return false;
+
+            clau_compat::ReadOnlyFile file;
+            clau_compat::FileIdentity id;
+            if (!file.Open(fileName.c_str()) || !file.Identify(id)) return false;
+            if (id.device != appended.identity.device || id.file != appended.identity.file) return false;
+            const int64_t length = id.size - appended.bom;
+            if (length < appended.length || !TokenFits<Token>(length)) return false;
+
+            utf8_error = -1;
+            strings.Reset();
+            if (stats) stats->Reset();
+            ok = true;
+            if (length == appended.length && id.mtime == appended.identity.mtime) {  // 그대로
+                tokens = token_dense.data;
+                token_len = appended.token_len;
+                return true;
             }
-        }
-    };
+            if (length == appended.length || !SamePrefix(file)) return false;
 
-    // BomInfo 정의 (UTF-8 BOM: EF BB BF)
-    inline const Utility::BomInfo Utility::bomInfo[1] = {
-        { 3, { '\xEF', '\xBB', '\xBF', 0, 0 } }
-    };
+            // 덧붙은 바이트만 읽는다. 버퍼는 1.5배씩 늘려 옮기는 비용을 나눠 갚는다
+            const int64_t a = LoadStats::Clock(stats);
+            if (buffer_len < length) {
+                int64_t capacity = std::max(length, buffer_len + buffer_len / 2);
+                if (!TokenFits<Token>(capacity)) capacity = length;
+                char* bigger = new (std::nothrow) char[capacity + 1];
+                if (!bigger) return false;
+                memcpy(bigger, buffer, static_cast<size_t>(appended.length));
+                delete[] buffer;
+                buffer = bigger;
+                buffer_len = capacity;
+                text = buffer;
+            }
+            appended.valid = false;
+            ok = file.ReadAt(buffer + appended.length, length - appended.length, appended.bom + appended.length);
+            if (!ok) return true;
+            buffer[length] = '\0';
+            text_len = length;
+            if (stats) {
+                stats->read_ns += LoadStats::Clock(stats) - a;
+                stats->input_bytes = buffer_len + 1;
+            }
 
-    inline uint8_t char_to_token_type[256];
+            // resume 부터 끝까지를 아레나에 스캔 (COUNT_FIRST 여도 연속 배열을 지우지 않도록 ARENAS 로)
+            const int64_t resume = appended.resume;
+            const int64_t keep = appended.resume_tokens;
+            bool in_string = appended.in_string;
+            std::vector<Token*> token_arr;
+            std::vector<int64_t> token_arr_sizes;
+            int64_t token_arr_len = 0;
+            int64_t tail_error = -1;
+            ok = Scan(pool, buffer + resume, length - resume, in_string, thr_num, json_lines,
+                TokenStorage::ARENAS, arenas, token_dense,
+                token_arr, token_arr_sizes, token_arr_len, level, chunk_policy,
+                validate_utf8 ? &tail_error : nullptr, stats);
+            if (tail_error >= 0) utf8_error = resume + tail_error;
+            ok = ok && token_dense.Reserve(keep + token_arr_len + 1);
+            if (!ok) return true;
 
+            // 조각을 resume 만큼 옮겨 연속 배열 keep 뒤에 잇는다
+            const int64_t b = LoadStats::Clock(stats);
+            const int64_t chunk_num = static_cast<int64_t>(token_arr.size());
+            std::vector<int64_t> offset(chunk_num + 1, keep);
+            for (int64_t t = 0; t < chunk_num; ++t) offset[t + 1] = offset[t] + token_arr_sizes[t];
+            Token* dense = token_dense.data;
+            uint8_t* types = token_dense.typed ? token_dense.types : nullptr;
+            const int workers = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(thr_num, chunk_num)));
+            StealingScheduler sched;
+            sched.Reset(chunk_num, workers);
+            pool.Run(workers, [&](int w) {
+                int64_t t;
+                while (sched.Next(w, t)) {
+                    const Token* from = token_arr[t];
+                    Token* to = dense + offset[t];
+                    for (int64_t k = 0; k < token_arr_sizes[t]; ++k) to[k] = static_cast<Token>(from[k] + resume);
+                    if (types) memcpy(types + offset[t], arenas[t].types, static_cast<size_t>(token_arr_sizes[t]));
+                }
+                });
+            token_len = offset[chunk_num];
+            dense[token_len] = static_cast<Token>(length);
+            if (types) types[token_len] = TokenType::END;
+            tokens = dense;
+            if (token_storage == TokenStorage::COUNT_FIRST) {
+                for (auto& arena : arenas) arena.Release();
+                arenas.clear();
+            }
+            if (stats) stats->sentinel_ns += LoadStats::Clock(stats) - b;
 
-    class InFileReserver {
-    private:
-        char* buffer = nullptr;
-        int64_t buffer_len = 0;
-        Token* token_orig = nullptr;
-        int64_t token_orig_len = 0;
+            RememberAppend(fileName, tokens, token_len);
+            return true;
+        }
 
-    public:
-        ~InFileReserver() {
-            delete[] buffer;
-            free(token_orig);
+        // 토큰 t 의 종류 : stage 1 이 쓴 종류 배열이 있으면 거기서, 없으면 입력의 첫 바이트로
+        static __forceinline TokenType TypeOf(const char* text, const Token* tokens, const uint8_t* types, int64_t t) {
+            return static_cast<TokenType>(types ? types[t] : char_to_token_type[static_cast<uint8_t>(text[tokens[t]])]);
         }
 
-    private:
-        InFileReserver(const InFileReserver&) = delete;
-        InFileReserver& operator=(const InFileReserver&) = delete;
+        // ── 테이프 구성 (병렬 구조 파싱) ─────────────────────────────────
+        //  토큰 배열을 thr_num 개 구간으로 나눠
+        //   1) 구간마다 값 개수, 깊이 변화, 최저 깊이를 센다
+        //   2) barrier : prefix sum 으로 구간의 테이프 시작 위치와 시작 깊이를 정한다.
+        //      시작 깊이 + 최저 깊이 < 0 이면 짝 없는 닫힘, 끝 깊이 != 0 이면 짝 없는 열림
+        //   3) 구간마다 자기 자리에 테이프를 쓰고, 구간 안에서 짝이 맞는 괄호는 바로 잇는다
+        //   4) 구간 밖과 짝인 괄호(구간마다 최대 깊이 변화만큼)만 순서대로 이어 붙인다
+        struct TapeRange {
+            int64_t first = 0, last = 0;       // 토큰 구간
+            int64_t values = 0;                // 테이프 칸 수
+            int64_t depth = 0, min_depth = 0;  // 구간 안 깊이 변화 (시작 = 0)
+            int64_t tape_start = 0;
+            bool failed = false;               // 괄호 종류가 맞지 않음
+            std::vector<int64_t> open;         // 구간 안에서 닫히지 않은 열림 (테이프 인덱스, 바깥→안쪽)
+            std::vector<int64_t> close;        // 구간 밖의 열림과 짝인 닫힘 (테이프 인덱스, 순서대로)
+        };
+
+        // 열림 칸 open 과 닫힘 칸 close 를 잇는다. { 는 } 와, [ 는 ] 와만 짝이 된다
+        static __forceinline bool LinkTape(uint64_t* words, int64_t open, int64_t close) {
+            const TokenType open_type = Tape::TypeOf(words[open]);
+            const TokenType close_type = Tape::TypeOf(words[close]);
+            if (static_cast<int>(close_type) != static_cast<int>(open_type) + 1) return false;
+            words[open] = Tape::Make(open_type, static_cast<uint64_t>(close + 1));
+            words[close] = Tape::Make(close_type, static_cast<uint64_t>(open));
+            return true;
+        }
 
-        // ── Stage 1: AVX2로 토큰 후보 추출 ────────────────────────────
-        static void ScanWithSimdJsonStyle(const char* text, int64_t num, int64_t length,
-            Token* token_arr, int64_t& token_arr_size,
-            int64_t* _quoted_count)
+        static bool BuildTape(WorkerPool& pool, const char* text, const Token* tokens, const uint8_t* types,
+            int64_t token_len, int thr_num, Tape& tape)
         {
-            int64_t i = 0;
-            int64_t token_first = 0;
-            int64_t token_count = 0;
-            int64_t quoted_count = 0;
-            int32_t backslash_on = -1;
+            constexpr int64_t min_range = int64_t(64) << 10;
+            const int range_num = static_cast<int>(std::max<int64_t>(1,
+                std::min<int64_t>(thr_num, token_len / min_range)));
 
-            auto flush_word = [&](int64_t end_idx) {
-                if (end_idx > token_first) {
-                    token_arr[token_count++] = Utility::Get(token_first + num, end_idx - token_first, text);
-                }
-                };
+            std::vector<TapeRange> ranges(range_num);
+            for (int r = 0; r < range_num; ++r) {
+                ranges[r].first = token_len * r / range_num;
+                ranges[r].last = token_len * (r + 1) / range_num;
+            }
 
-            while (i + 32 <= length) {
-                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
-                uint32_t mask = get_delimiter_mask_avx2(chunk);
+            uint64_t* words = nullptr;
+            bool balanced = true;
 
-                while (mask != 0) {
-                    uint32_t bit_idx = _tzcnt_u32(mask);
+            pool.Run(range_num, [&](int r) {
+                TapeRange& range = ranges[r];
+                int64_t values = 0, depth = 0, min_depth = 0;
+                for (int64_t t = range.first; t < range.last; ++t) {
+                    switch (TypeOf(text, tokens, types, t)) {
+                    case TokenType::LEFT_BRACE: case TokenType::LEFT_BRACKET:
+                        ++values; ++depth;
+                        break;
+                    case TokenType::RIGHT_BRACE: case TokenType::RIGHT_BRACKET:
+                        ++values; --depth;
+                        min_depth = std::min(min_depth, depth);
+                        break;
+                    case TokenType::ASSIGNMENT: case TokenType::COMMA:
+                        break;
+                    default:
+                        ++values;
+                        break;
+                    }
+                }
+                range.values = values;
+                range.depth = depth;
+                range.min_depth = min_depth;
 
-                    if (backslash_on >= 0) {
-                        if (i + static_cast<int64_t>(bit_idx) == backslash_on) {
-                            backslash_on = -1;
-                            mask = _blsr_u32(mask);
-                            continue;
+                pool.Barrier([&] {
+                    int64_t tape_len = 0, level = 0;
+                    for (auto& x : ranges) {
+                        x.tape_start = tape_len;
+                        tape_len += x.values;
+                        if (level + x.min_depth < 0) balanced = false;
+                        level += x.depth;
+                    }
+                    if (level != 0) balanced = false;
+                    if (balanced) words = tape.Resize(tape_len);
+                    });
+                if (!words) return;
+
+                range.open.clear();
+                range.close.clear();
+                int64_t k = range.tape_start;
+                for (int64_t t = range.first; t < range.last; ++t) {
+                    const TokenType type = TypeOf(text, tokens, types, t);
+                    switch (type) {
+                    case TokenType::LEFT_BRACE: case TokenType::LEFT_BRACKET:
+                        words[k] = Tape::Make(type, 0);
+                        range.open.push_back(k++);
+                        break;
+                    case TokenType::RIGHT_BRACE: case TokenType::RIGHT_BRACKET:
+                        words[k] = Tape::Make(type, 0);
+                        if (range.open.empty()) range.close.push_back(k);
+                        else {
+                            if (!LinkTape(words, range.open.back(), k)) range.failed = true;
+                            range.open.pop_back();
                         }
-                        backslash_on = -1;
+                        ++k;
+                        break;
+                    case TokenType::ASSIGNMENT: case TokenType::COMMA:
+                        break;
+                    default:
+                        words[k++] = Tape::Make(type, tokens[t]);
+                        break;
                     }
+                }
+                });
+
+            if (!words) {
+                tape.Resize(0);
+                return false;
+            }
+
+            // 구간 경계를 넘는 괄호 : 열림은 스택에 쌓고, 다음 구간들의 짝 없는 닫힘이 차례로 꺼낸다.
+            // 깊이 검사를 통과했으므로 스택이 모자라거나 남지 않는다.
+            std::vector<int64_t> stack;
+            bool ok = true;
+            for (auto& range : ranges) {
+                ok = ok && !range.failed;
+                for (int64_t close : range.close) {
+                    ok = ok && LinkTape(words, stack.back(), close);
+                    stack.pop_back();
+                }
+                stack.insert(stack.end(), range.open.begin(), range.open.end());
+            }
+
+            if (!ok) tape.Resize(0);
+            return ok;
+        }
+
+        // ── 괄호 짝 인덱스 구성 ─────────────────────────────────────────
+        //  토큰 배열을 thr_num 개 구간으로 나눠
+        //   1) 구간마다 스택으로 구간 안의 짝을 바로 잇고, 깊이 변화와 최저 깊이를 센다.
+        //      남는 것은 앞 구간과 짝인 닫힘들과 뒤 구간과 짝인 열림들뿐이다
+        //   2) barrier : prefix sum 으로 구간의 시작 깊이를 정한다 (짝 없는 괄호는 여기서 실패).
+        //      남은 닫힘은 깊이 [시작 + 최저, 시작), 남은 열림은 [시작 + 최저, 시작 + 최저 + 열림 수)
+        //      연속 구간을 차지하고, 한 구간 안에서 닫힘이 열림보다 앞에 있다
+        //   3) 깊이마다 병렬로 : 구간 순서대로 훑으며 그 깊이의 열림과 바로 다음 닫힘을 잇는다
+        struct BracketRange {
+            int64_t first = 0, last = 0;       // 토큰 구간
+            int64_t depth = 0, min_depth = 0;  // 구간 안 깊이 변화 (시작 = 0)
+            int64_t start_depth = 0;
+            bool failed = false;               // 괄호 종류가 맞지 않음
+            std::vector<int64_t> open;         // 닫히지 않은 열림 (토큰 번호, 바깥→안쪽)
+            std::vector<int64_t> close;        // 앞 구간의 열림과 짝인 닫힘 (토큰 번호, 안쪽→바깥)
+        };
+
+        static __forceinline bool LinkBrackets(const char* text, const Token* tokens, const uint8_t* types, Token* match,
+            int64_t open, int64_t close)
+        {
+            const TokenType open_type = TypeOf(text, tokens, types, open);
+            const TokenType close_type = TypeOf(text, tokens, types, close);
+            match[open] = static_cast<Token>(close);
+            match[close] = static_cast<Token>(open);
+            return static_cast<int>(close_type) == static_cast<int>(open_type) + 1;
+        }
+
+        static bool BuildBracketIndex(WorkerPool& pool, const char* text, const Token* tokens, const uint8_t* types,
+            int64_t token_len, int thr_num, BracketIndex& index)
+        {
+            constexpr int64_t min_range = int64_t(64) << 10;
+            const int range_num = static_cast<int>(std::max<int64_t>(1,
+                std::min<int64_t>(thr_num, token_len / min_range)));
 
-                    mask = _blsr_u32(mask);
+            Token* match = index.Resize(token_len);
+            if (!match) return false;
 
-                    int64_t actual_idx = i + static_cast<int64_t>(bit_idx);
-                    char ch = text[actual_idx];
+            std::vector<BracketRange> ranges(range_num);
+            for (int r = 0; r < range_num; ++r) {
+                ranges[r].first = token_len * r / range_num;
+                ranges[r].last = token_len * (r + 1) / range_num;
+            }
 
-                    flush_word(actual_idx);
+            bool balanced = true;
+            int64_t depth_num = 0;  // 구간 경계를 넘는 짝이 있는 깊이 수
+            std::atomic<bool> matched{ true };
 
-                    if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t') {
-                        token_first = actual_idx + 1;
+            pool.Run(range_num, [&](int r) {
+                BracketRange& range = ranges[r];
+                range.open.clear();
+                range.close.clear();
+                bool ok = true;
+                for (int64_t t = range.first; t < range.last; ++t) {
+                    switch (TypeOf(text, tokens, types, t)) {
+                    case TokenType::LEFT_BRACE: case TokenType::LEFT_BRACKET:
+                        range.open.push_back(t);
+                        break;
+                    case TokenType::RIGHT_BRACE: case TokenType::RIGHT_BRACKET:
+                        if (range.open.empty()) range.close.push_back(t);
+                        else {
+                            ok &= LinkBrackets(text, tokens, types, match, range.open.back(), t);
+                            range.open.pop_back();
+                        }
+                        break;
+                    default:
+                        break;
                     }
-                    else if (ch == '\\') {
-                        token_first = actual_idx;
-                        backslash_on = static_cast<int32_t>(actual_idx + 1);
+                }
+                range.failed = !ok;
+                range.min_depth = -static_cast<int64_t>(range.close.size());
+                range.depth = range.min_depth + static_cast<int64_t>(range.open.size());
+
+                pool.Barrier([&] {
+                    int64_t level = 0;
+                    for (auto& x : ranges) {
+                        x.start_depth = level;
+                        if (level + x.min_depth < 0) balanced = false;
+                        level += x.depth;
+                        depth_num = std::max<int64_t>(depth_num, level);
                     }
-                    else {
-                        quoted_count += !(ch - '"');
-                        token_arr[token_count++] = Utility::Get(actual_idx + num, 1, text);
-                        token_first = actual_idx + 1;
+                    if (level != 0) balanced = false;
+                    });
+                if (!balanced) return;
+
+                // 깊이 d 를 range_num 개 스레드가 나눠 맡는다
+                for (int64_t d = r; d < depth_num; d += range_num) {
+                    int64_t open = -1;
+                    for (const auto& x : ranges) {
+                        const int64_t floor = x.start_depth + x.min_depth;
+                        if (d >= floor && d < x.start_depth) {  // 이 구간의 닫힘 (안쪽부터 쌓였다)
+                            if (!LinkBrackets(text, tokens, types, match, open, x.close[x.start_depth - 1 - d]))
+                                matched.store(false, std::memory_order_relaxed);
+                        }
+                        if (d >= floor && d < floor + static_cast<int64_t>(x.open.size()))
+                            open = x.open[d - floor];
                     }
                 }
-                i += 32;
-            }
+                });
 
-            // 나머지 스칼라 처리
-            while (i < length) {
-                char ch = text[i];
-                switch (ch) {
-                case ' ': case '\t': case '\r': case '\v': case '\f': case '\n':
-                    flush_word(i);
-                    token_first = i + 1;
-                    break;
-                case '"':
-                    ++quoted_count;
-                    flush_word(i);
-                    token_arr[token_count++] = Utility::Get(i + num, 1, nullptr);
-                    token_first = i + 1;
-                    break;
-                case ',':
-                    flush_word(i);
-                    token_arr[token_count++] = Utility::Get(i + num, 1, nullptr);
-                    token_first = i + 1;
-                    break;
-                case '\\':
-                    flush_word(i);
-                    token_first = i;
-                    break;
-                case LoadDataOption::LeftBrace:  case LoadDataOption::LeftBracket:
-                case LoadDataOption::RightBrace: case LoadDataOption::RightBracket:
-                case LoadDataOption::Assignment:
-                    flush_word(i);
-                    token_arr[token_count++] = Utility::Get(i + num, 1, nullptr);
-                    token_first = i + 1;
-                    break;
+            bool ok = balanced && matched.load(std::memory_order_relaxed);
+            for (const auto& range : ranges) ok = ok && !range.failed;
+
+            if (!ok) index.Resize(0);
+            return ok;
+        }
+
+        // ── 스칼라 값 해석 (병렬) ─────────────────────────────────────────
+        //  토큰 배열을 thr_num 개 구간으로 나눠, 문자열이 아닌 값 토큰마다 리터럴을 확인하고
+        //  숫자를 해석해 토큰 번호 자리에 쓴다. 구간 사이 의존이 없으므로 barrier 도 없다.
+        static bool BuildScalarValues(WorkerPool& pool, const char* text, const Token* tokens, const uint8_t* types,
+            int64_t token_len, int thr_num, ScalarValues& scalars)
+        {
+            constexpr int64_t min_range = int64_t(64) << 10;
+            const int range_num = static_cast<int>(std::max<int64_t>(1,
+                std::min<int64_t>(thr_num, token_len / min_range)));
+
+            if (!scalars.Resize(token_len)) return false;
+            uint8_t* kinds = scalars.KindData();
+            ScalarValue* values = scalars.ValueData();
+            std::vector<int64_t> first_invalid(range_num, -1);
+
+            pool.Run(range_num, [&](int r) {
+                const int64_t first = token_len * r / range_num;
+                const int64_t last = token_len * (r + 1) / range_num;
+                for (int64_t t = first; t < last; ++t) {
+                    const int64_t pos = static_cast<int64_t>(tokens[t]);
+                    ScalarKind kind = ScalarKind::NONE;
+                    switch (TypeOf(text, tokens, types, t)) {
+                    case TokenType::LEFT_BRACE: case TokenType::LEFT_BRACKET:
+                    case TokenType::RIGHT_BRACE: case TokenType::RIGHT_BRACKET:
+                    case TokenType::ASSIGNMENT: case TokenType::COMMA:
+                    case TokenType::STRING:
+                        break;
+                    default:
+                        kind = NumberParser::Classify(text + pos,
+                            text + Utility::TokenEnd(text, pos, static_cast<int64_t>(tokens[t + 1])), values[t]);
+                        if (kind == ScalarKind::INVALID && first_invalid[r] < 0) first_invalid[r] = t;
+                        break;
+                    }
+                    kinds[t] = static_cast<uint8_t>(kind);
                 }
-                ++i;
-            }
-            flush_word(length);
-            token_arr_size = token_count;
-            _quoted_count[0] = quoted_count;
+                });
+
+            for (int64_t t : first_invalid)
+                if (t >= 0) { scalars.SetFirstInvalid(t); break; }
+            return true;
+        }
+
+        // ── 문법 검증 (병렬) ─────────────────────────────────────────────
+        //  JSON 문법은 이웃한 두 토큰 (a, b) 와 그 사이의 문맥 (가장 안쪽의 열린 컨테이너 : 객체 / 배열 / 최상위)
+        //  만으로 판정된다. a 가 문자열이면 키인지(객체 안에서 '{' 나 ',' 바로 뒤)도 본다.
+        //  토큰 배열을 thr_num 개 구간으로 나누면, 구간 안에서 연 괄호 안의 문맥은 구간 스택으로 알지만
+        //  구간 시작 깊이 이하(바닥)의 문맥은 모른다. 그래서 구간마다 전이 함수를 만든다:
+        //   - 구간 안에서 연 괄호 안의 첫 오류 (문맥이 정해져 있다)
+        //   - 바닥에서는 세 문맥을 모두 가정해 가정별 첫 오류를 적는다. 시작 깊이 아래로 내려가는 닫힘마다
+        //     한 묶음을 끊고(그 바닥의 문맥은 그 닫힘과 짝인 열림이 정한다), 마지막 바닥은 tail
+        //   - 짝 없는 닫힘 수와 닫히지 않은 열림
+        //  구간 순서대로 스택을 이어 붙이며 (BuildTape 의 경계 괄호와 같다) 바닥마다 실제 문맥의 오류를 고르고,
+        //  가장 앞선 오류를 바이트 오프셋으로 돌려준다. 입력이 값 중간에 끝나면 입력 길이.
+        //  최상위 값은 하나뿐이다. multiple (JSON Lines) 이면 여러 개를 허용하고 줄 경계는 BuildRecordIndex 가 본다.
+        //  word 가 올바른 숫자 / 리터럴인지는 보지 않는다 (BuildScalarValues).
+        enum GrammarContext { IN_OBJECT, IN_ARRAY, AT_TOP };
+        enum GrammarClass { G_BEGIN, G_OPEN_OBJECT, G_OPEN_ARRAY, G_COLON, G_COMMA, G_KEY, G_VALUE };
+
+        static constexpr uint32_t GrammarBit(TokenType type) { return uint32_t(1) << type; }
+
+        // kGrammar[앞 토큰 분류][문맥] : 다음에 올 수 있는 토큰 종류의 비트 집합 (END = 입력 끝).
+        // 최상위 값 뒤의 kValueStart 는 multiple 일 때만 (Allowed)
+        static constexpr uint32_t kValueStart = GrammarBit(LEFT_BRACE) | GrammarBit(LEFT_BRACKET) | GrammarBit(STRING)
+            | GrammarBit(NUMBER) | GrammarBit(TRUE) | GrammarBit(FALSE) | GrammarBit(_NULL);
+        static constexpr uint32_t kGrammar[7][3] = {
+            /* G_BEGIN       */ { kValueStart, kValueStart, kValueStart | GrammarBit(END) },
+            /* G_OPEN_OBJECT */ { GrammarBit(STRING) | GrammarBit(RIGHT_BRACE), 0, 0 },
+            /* G_OPEN_ARRAY  */ { 0, kValueStart | GrammarBit(RIGHT_BRACKET), 0 },
+            /* G_COLON       */ { kValueStart, 0, 0 },
+            /* G_COMMA       */ { GrammarBit(STRING), kValueStart, 0 },
+            /* G_KEY         */ { GrammarBit(ASSIGNMENT), 0, 0 },
+            /* G_VALUE       */ { GrammarBit(COMMA) | GrammarBit(RIGHT_BRACE), GrammarBit(COMMA) | GrammarBit(RIGHT_BRACKET),
+                                  kValueStart | GrammarBit(END) },
+        };
+
+        //  a, a2 : 바로 앞 / 그 앞 토큰 종류 (없으면 -1). 문자열만 키인지 따로 본다
+        static constexpr uint8_t kClassOf[END + 2] = {
+            G_BEGIN,
+            G_OPEN_OBJECT, G_VALUE, G_OPEN_ARRAY, G_VALUE,  // { } [ ]
+            G_COLON, G_COMMA,                               // : ,
+            G_VALUE, G_VALUE, G_VALUE, G_VALUE, G_VALUE, G_VALUE, G_VALUE, G_VALUE, G_VALUE,
+        };
+        static __forceinline int ClassOf(int a, int a2, int context) {
+            if (a == TokenType::STRING && context == IN_OBJECT && (a2 == TokenType::LEFT_BRACE || a2 == TokenType::COMMA))
+                return G_KEY;
+            return kClassOf[a + 1];
+        }
+
+        static __forceinline bool Allowed(int a, int a2, int b, int context, bool multiple) {
+            const int cls = ClassOf(a, a2, context);
+            if (cls == G_VALUE && context == AT_TOP && !multiple) return b == TokenType::END;
+            return (kGrammar[cls][context] >> b) & 1;
         }
 
-        // ── Stage 1 (SSE4.2 경로) ──────────────────────────────────────
-        static void _Scanning_SIMD(char* text, int64_t num, const int64_t length,
-            Token*& token_arr,
-            std::array<int64_t, 2>& _token_arr_size,
-            bool /*is_last*/, std::array<int, 2>& /*_last_state*/)
+        struct GrammarRange {
+            int64_t first = 0, last = 0;                // 토큰 구간
+            int64_t error = -1;                         // 구간 안에서 연 괄호 안의 첫 오류 (토큰 번호)
+            std::array<int64_t, 3> tail{ -1, -1, -1 };  // 마지막 바닥의 문맥별 첫 오류
+            std::vector<std::array<int64_t, 3>> floors; // 짝 없는 닫힘마다 그 닫힘까지의 바닥 오류
+            std::vector<int64_t> open;                  // 닫히지 않은 열림 (토큰 번호, 바깥→안쪽)
+        };
+
+        static void BuildGrammarCheck(WorkerPool& pool, const char* text, int64_t length, const Token* tokens,
+            const uint8_t* types, int64_t token_len, int thr_num, bool multiple, int64_t& error)
         {
-            if (length <= 0) { _token_arr_size[0] = 0; return; }
+            constexpr int64_t min_range = int64_t(64) << 10;
+            const int range_num = static_cast<int>(std::max<int64_t>(1,
+                std::min<int64_t>(thr_num, token_len / min_range)));
 
-            int64_t token_arr_count = 0;
-            int64_t token_first = 0;
-            int64_t i = 0;
-
-            const __m128i delimiters = _mm_setr_epi8(
-                ' ', '\t', '\r', '\n', '\v', '\f',
-                '{', '}', '[', ']', ':', ',', '"', '\\',
-                0, 0
-            );
-            constexpr int mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
-
-            auto flush = [&](int64_t end_index) {
-                int64_t len = end_index - token_first;
-                if (len > 0)
-                    token_arr[token_arr_count++] =
-                    Utility::Get(token_first + num, len, text + token_first);
-                };
+            std::vector<GrammarRange> ranges(range_num);
+            for (int r = 0; r < range_num; ++r) {
+                ranges[r].first = token_len * r / range_num;
+                ranges[r].last = token_len * (r + 1) / range_num;
+            }
 
-            while (i + 16 <= length) {
-                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
-
-                if (_mm_cmpistrc(chunk, delimiters, mode)) {
-                    int64_t end = i + 16;
-                    while (i < end) {
-                        char ch = text[i];
-                        switch (ch) {
-                        case ' ': case '\t': case '\r': case '\n': case '\v': case '\f':
-                            flush(i); token_first = i + 1; break;
-                        case '"': case ',':
-                            flush(i);
-                            token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                            token_first = i + 1;
-                            break;
-                        case '\\':
-                            if (i + 1 < length && (text[i + 1] == '\\' || text[i + 1] == '"')) {
-                                token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                                ++i;
-                                token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                                token_first = i + 1;
-                            }
-                            break;
-                        case '{': case '[': case '}': case ']': case ':':
-                            flush(i);
-                            token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                            token_first = i + 1;
-                            break;
+            pool.Run(range_num, [&](int r) {
+                GrammarRange& range = ranges[r];
+                range.floors.clear();
+                range.open.clear();
+                std::vector<uint8_t> context;  // 구간 안에서 연 괄호의 문맥
+                std::array<int64_t, 3> floor{ -1, -1, -1 };
+                int prev = range.first > 0 ? TypeOf(text, tokens, types, range.first - 1) : -1;
+                int prev2 = range.first > 1 ? TypeOf(text, tokens, types, range.first - 2) : -1;
+                for (int64_t t = range.first; t < range.last; ++t) {
+                    const int type = TypeOf(text, tokens, types, t);
+                    if (!context.empty()) {
+                        if (!Allowed(prev, prev2, type, context.back(), multiple)) { range.error = t; break; }  // 뒤는 볼 필요 없다
+                    }
+                    else {
+                        for (int c = IN_OBJECT; c <= AT_TOP; ++c)
+                            if (floor[c] < 0 && !Allowed(prev, prev2, type, c, multiple)) floor[c] = t;
+                    }
+                    switch (type) {
+                    case TokenType::LEFT_BRACE: case TokenType::LEFT_BRACKET:
+                        context.push_back(type == TokenType::LEFT_BRACE ? IN_OBJECT : IN_ARRAY);
+                        range.open.push_back(t);
+                        break;
+                    case TokenType::RIGHT_BRACE: case TokenType::RIGHT_BRACKET:
+                        if (!context.empty()) {
+                            context.pop_back();
+                            range.open.pop_back();
+                        }
+                        else {
+                            range.floors.push_back(floor);
+                            floor = { -1, -1, -1 };
                         }
-                        ++i;
+                        break;
+                    default:
+                        break;
                     }
+                    prev2 = prev;
+                    prev = type;
                 }
-                else {
-                    i += 16;
+                range.tail = floor;
+                });
+
+            // 구간 순서대로 : 바닥의 실제 문맥 = 앞 구간들이 남긴 스택의 맨 위
+            int64_t first_error = -1;  // 토큰 번호 (token_len = 입력 끝)
+            auto note = [&](int64_t t) { if (t >= 0 && (first_error < 0 || t < first_error)) first_error = t; };
+            std::vector<int64_t> stack;
+            auto context_of = [&] {
+                if (stack.empty()) return AT_TOP;
+                return TypeOf(text, tokens, types, stack.back()) == TokenType::LEFT_BRACE ? IN_OBJECT : IN_ARRAY;
+                };
+            for (const auto& range : ranges) {
+                note(range.error);
+                for (const auto& floor : range.floors) {
+                    note(floor[context_of()]);
+                    if (!stack.empty()) stack.pop_back();  // 비어 있으면 AT_TOP 가정에서 이미 오류
                 }
+                note(range.tail[context_of()]);
+                stack.insert(stack.end(), range.open.begin(), range.open.end());
             }
 
-            while (i < length) {
-                char ch = text[i];
-                switch (ch) {
-                case ' ': case '\t': case '\r': case '\n': case '\v': case '\f':
-                    flush(i); token_first = i + 1; break;
-                case '"': case ',':
-                    flush(i);
-                    token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                    token_first = i + 1;
-                    break;
-                case '\\':
-                    if (i + 1 < length && (text[i + 1] == '\\' || text[i + 1] == '"')) {
-                        token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                        ++i;
-                        token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                        token_first = i + 1;
-                    }
-                    break;
-                case '{': case '[': case '}': case ']': case ':':
-                    flush(i);
-                    token_arr[token_arr_count++] = Utility::Get(i + num, 1, text + i);
-                    token_first = i + 1;
-                    break;
-                }
-                ++i;
+            // 입력 끝 : 닫히지 않은 괄호, 값을 기다리는 중, 닫히지 않은 문자열
+            if (!stack.empty()) note(token_len);
+            if (token_len > 0) {
+                const int last = TypeOf(text, tokens, types, token_len - 1);
+                const int last2 = token_len > 1 ? TypeOf(text, tokens, types, token_len - 2) : -1;
+                if (!Allowed(last, last2, TokenType::END, context_of(), multiple)) note(token_len);
+                if (last == TokenType::STRING && !StringClosed(text, static_cast<int64_t>(tokens[token_len - 1]), length))
+                    note(token_len - 1);
             }
+            error = first_error < 0 ? -1 : first_error < token_len ? static_cast<int64_t>(tokens[first_error]) : length;
+        }
 
-            flush(length);
-            _token_arr_size[0] = token_arr_count;
+        // 입력의 마지막 토큰인 문자열 (여는 따옴표 pos) 이 닫혔는가 : 끝 공백을 걷어낸 마지막 바이트가
+        // escape 되지 않은 따옴표여야 한다
+        static bool StringClosed(const char* text, int64_t pos, int64_t length) {
+            const int64_t end = Utility::TokenEnd(text, pos, length);
+            if (end - pos < 2 || text[end - 1] != '"') return false;
+            int64_t backslash = 0;
+            for (int64_t x = end - 2; x > pos && text[x] == '\\'; --x) ++backslash;
+            return backslash % 2 == 0;
         }
 
-        // ── Stage 1 (스칼라 경로) ──────────────────────────────────────
-        static void _Scanning(char* text, int64_t num, const int64_t length,
-            Token*& token_arr,
-            std::array<int64_t, 2>& _token_arr_size,
-            bool /*is_last*/, std::array<int, 2>& /*_last_state*/,
-            int64_t* out_quote_count)
-        {
-            if (length <= 0) { _token_arr_size[0] = 0; return; }
+        // ── 레코드 인덱스 구성 (JSON Lines, 병렬) ─────────────────────────
+        //  레코드 = 최상위 값 하나 = 깊이 0 에서 시작하는 토큰부터 다음 그런 토큰 앞까지.
+        //  JSON Lines 이면 레코드마다 제 줄이 있어야 하므로 둘을 본다.
+        //   - 레코드 시작 바로 앞 공백에 줄바꿈이 있다 (없으면 한 줄에 값이 둘 이상)
+        //   - 레코드 원문(끝 공백 제외)에 줄바꿈이 없다 (있으면 값이 여러 줄에 걸치거나 문자열 안의 날 줄바꿈)
+        //  토큰 사이 공백은 언제나 문자열 밖이므로 위 두 검사가 곧 "문자열 밖 줄바꿈 = 레코드 경계" 이다.
+        //  1) 구간마다 상대 깊이를 세며 가장 얕은 깊이에서 시작하는 토큰을 모은다 (더 얕아지면 버린다)
+        //  2) barrier : prefix sum 으로 구간 시작 깊이와 레코드 번호를 정한다.
+        //     (구간 시작 깊이 + 최저 깊이) 가 0 인 구간의 모음만 레코드 시작이다
+        //  3) 제자리에 기록 → barrier → 구간마다 자기 레코드를 memchr 로 검사
+        //  error : 처음 어긋난 토큰의 오프셋 (없으면 -1). 괄호 짝이 안 맞는 입력은 문법 검증의 몫이다
+        struct RecordRange {
+            int64_t first = 0, last = 0;   // 토큰 구간
+            int64_t depth = 0;             // 구간 끝 상대 깊이
+            int64_t low = 0;               // 구간 안 토큰 앞 깊이의 최솟값
+            std::vector<int64_t> starts;   // 깊이 low 에서 시작하는 토큰
+            int64_t offset = 0;            // 첫 레코드 번호
+            int64_t count = 0;             // 이 구간에서 시작하는 레코드 수
+            int64_t bad = -1;              // 처음 어긋난 토큰 번호
+        };
 
-            int64_t token_arr_count = 0;
-            int64_t token_first = 0;
-            int64_t quote_count = 0;
+        // TokenType → 깊이 변화
+        static constexpr int8_t kDepthDelta[TokenType::END + 1] = { 1, -1, 1, -1 };
+        static_assert(TokenType::LEFT_BRACE == 0 && TokenType::RIGHT_BRACE == 1 &&
+            TokenType::LEFT_BRACKET == 2 && TokenType::RIGHT_BRACKET == 3, "kDepthDelta order");
 
-            char* p = text;
-            char* end = text + length;
+        // 토큰 t (> 0) 바로 앞 공백에 줄바꿈이 있는가
+        static __forceinline bool NewlineBefore(const char* text, const Token* tokens, int64_t t) {
+            const int64_t prev = static_cast<int64_t>(tokens[t - 1]);
+            for (int64_t x = static_cast<int64_t>(tokens[t]) - 1; x > prev; --x) {
+                if (text[x] == '\n') return true;
+                if (!Utility::isWhitespace(text[x])) return false;
+            }
+            return false;
+        }
 
-            auto flush = [&](int64_t end_index) {
-                int64_t len = end_index - token_first;
-                if (len > 0)
-                    token_arr[token_arr_count++] =
-                    Utility::Get(token_first + num, len, text + token_first);
-                };
+        // 레코드 k ∈ [from, to) 검사. 맞으면 -1, 아니면 처음 어긋난 토큰 번호.
+        //  레코드 원문 끝 = 다음 레코드 시작에서 공백을 걷어낸 곳이고, 걷어낸 공백에 줄바꿈이 있어야 한다.
+        static int64_t CheckRecords(const char* text, const Token* tokens, int64_t token_len,
+            const int64_t* first, int64_t from, int64_t to)
+        {
+            if (from < to && first[from] > 0 && !NewlineBefore(text, tokens, first[from])) return first[from];
+            for (int64_t k = from; k < to; ++k) {
+                const int64_t s = first[k], e = first[k + 1];
+                const int64_t lo = static_cast<int64_t>(tokens[s]);
+                int64_t hi = static_cast<int64_t>(tokens[e]);
+                bool newline = false;
+                while (hi > lo && Utility::isWhitespace(text[hi - 1])) newline |= text[--hi] == '\n';
 
-            while (p < end) {
-                char    ch = *p;
-                int64_t i = p - text;
+                if (const void* nl = memchr(text + lo, '\n', static_cast<size_t>(hi - lo))) {
+                    // 줄바꿈이 토큰 사이 공백에 있으면 그 다음 토큰, 토큰(문자열) 안이면 그 토큰
+                    const int64_t x = static_cast<const char*>(nl) - text;
+                    const int64_t t = std::upper_bound(tokens + s, tokens + e, static_cast<Token>(x)) - tokens;
+                    for (int64_t y = static_cast<int64_t>(tokens[t]) - 1; y > x; --y)
+                        if (!Utility::isWhitespace(text[y])) return t - 1;
+                    return t;
+                }
+                if (!newline && e < token_len) return e;
+            }
+            return -1;
+        }
 
-                switch (ch) {
-                case ' ': case '\t': case '\r': case '\v': case '\f': case '\n':
-                    flush(i); token_first = i + 1; break;
+        static bool BuildRecordIndex(WorkerPool& pool, const char* text, const Token* tokens, const uint8_t* types,
+            int64_t token_len, int thr_num, RecordIndex& records, int64_t& error)
+        {
+            error = -1;
+            constexpr int64_t min_range = int64_t(64) << 10;
+            const int range_num = static_cast<int>(std::max<int64_t>(1,
+                std::min<int64_t>(thr_num, token_len / min_range)));
 
-                case '"':
-                    ++quote_count;
-                    flush(i);
-                    token_arr[token_arr_count++] = Utility::Get(i + num, 1, p);
-                    token_first = i + 1;
-                    break;
+            std::vector<RecordRange> ranges(range_num);
+            for (int r = 0; r < range_num; ++r) {
+                ranges[r].first = token_len * r / range_num;
+                ranges[r].last = token_len * (r + 1) / range_num;
+            }
 
-                case ',':
-                    flush(i);
-                    token_arr[token_arr_count++] = Utility::Get(i + num, 1, p);
-                    token_first = i + 1;
-                    break;
+            int64_t* first = nullptr;
+            bool ok = true;
 
-                case '\\':
-                    flush(i);
-                    if (p + 1 < end) {
-                        ++p;
-                        token_first = i;
+            pool.Run(range_num, [&](int r) {
+                RecordRange& range = ranges[r];
+                int64_t depth = 0;
+                for (int64_t t = range.first; t < range.last; ++t) {
+                    if (depth <= range.low) {
+                        if (depth < range.low) { range.low = depth; range.starts.clear(); }
+                        range.starts.push_back(t);
                     }
-                    else {
-                        token_first = i;
+                    depth += kDepthDelta[TypeOf(text, tokens, types, t)];  // switch 보다 분기 예측 실패가 적다
+                }
+                range.depth = depth;
+
+                pool.Barrier([&] {
+                    int64_t level = 0, count = 0;
+                    for (auto& x : ranges) {
+                        x.offset = count;
+                        x.count = level + x.low == 0 ? static_cast<int64_t>(x.starts.size()) : 0;
+                        level += x.depth;
+                        count += x.count;
                     }
-                    break;
+                    first = records.Resize(count);
+                    ok = first != nullptr;
+                    if (ok) first[count] = token_len;
+                    });
+                if (!ok) return;
 
-                case LoadDataOption::LeftBrace:  case LoadDataOption::LeftBracket:
-                case LoadDataOption::RightBrace: case LoadDataOption::RightBracket:
-                case LoadDataOption::Assignment:
-                    flush(i);
-                    token_arr[token_arr_count++] = Utility::Get(i + num, 1, p);
-                    token_first = i + 1;
-                    break;
-                }
-                ++p;
-            }
+                for (int64_t k = 0; k < range.count; ++k) first[range.offset + k] = range.starts[k];
+
+                pool.Barrier([] {});
 
-            flush(length);
-            _token_arr_size[0] = token_arr_count;
-            out_quote_count[0] = quote_count;
+                range.bad = CheckRecords(text, tokens, token_len, first, range.offset, range.offset + range.count);
+                });
+            if (!ok) return false;
+
+            for (const auto& range : ranges)
+                if (range.bad >= 0) { error = static_cast<int64_t>(tokens[range.bad]); break; }
+            return true;
         }
 
-        // ── Stage 2: 따옴표 쌍 병합 ────────────────────────────────────
-        static void _Scanning2(char* text, int64_t start, int64_t /*length*/,
-            Token*& token_arr, int64_t token_arr_size,
-            std::array<int64_t, 1>& _token_arr_size,
-            bool /*is_last*/, std::array<int, 1>& _last_state,
-            int /*id*/, const int64_t quote_count)
+        // ── 스캔 ───────────────────────────────────────────────────────
+        static bool Scan(WorkerPool& pool, const char* text, int64_t length, bool& in_string, int thr_num, bool lines,
+            TokenStorage storage, std::vector<TokenArena<Token>>& arenas, TokenArena<Token>& _dense,
+            std::vector<Token*>& _token_arr, std::vector<int64_t>& _token_arr_sizes, int64_t& _token_arr_len,
+            SimdLevel simd_level, const ChunkPolicy& policy, int64_t* utf8_error, LoadStats* stats)
         {
-            auto _text = text - start;
-            int   state = (quote_count % 2 == 1) ? 1 : 0;
-            Token* start_token = token_arr;
-            int64_t count = 0;
-            Token* token_arr_end = token_arr + token_arr_size;
-
-            for (Token* p = token_arr; p != token_arr_end; ++p) {
-                if (state == 0) {
-                    if (Utility::GetType(_text[*p]) == TokenType::QUOTED) {
-                        state = 1; start_token = p;
-                    }
-                    else if (Utility::GetType(_text[*p]) == TokenType::BACK_SLUSH) {
-                        // error
-                    }
-                    else {
-                        token_arr[count++] = *p;
-                    }
-                }
-                else {
-                    if (Utility::GetType(_text[*p]) == TokenType::QUOTED) {
-                        token_arr[count++] = *start_token;
-                        state = 0;
-                    }
-                }
+            if (storage == TokenStorage::COUNT_FIRST) {  // 아레나를 쓰지 않으므로 이전 것을 돌려준다
+                for (auto& arena : arenas) arena.Release();
+                arenas.clear();
             }
+            if (stats) stats->workers.resize(std::max<size_t>(stats->workers.size(), static_cast<size_t>(thr_num)));
+
+            int64_t token_arr_size = 0;
+            const bool ok = storage == TokenStorage::COUNT_FIRST
+                ? ScanningCounted(pool, text, length, in_string, thr_num, _dense, lines,
+                    _token_arr, _token_arr_sizes, token_arr_size, simd_level, policy, utf8_error, stats)
+                : ScanningNew(pool, text, length, in_string, thr_num, arenas, _dense.typed, lines,
+                    _token_arr, _token_arr_sizes, token_arr_size, simd_level, policy, utf8_error, stats);
 
-            if (state == 1) {
-                token_arr[count++] = *start_token;
+            _token_arr_len = token_arr_size;
+            if (stats) {
+                stats->bytes += length;
+                stats->tokens += token_arr_size;
             }
+            return ok;
+        }
+
+        SimdLevel simd_level = CpuFeatures::Best();
+        WorkerPool pool;  // 로드가 끝나도 워커를 유지 → 다음 로드에서 재사용
+        ChunkPolicy chunk_policy;
+        TokenStorage token_storage = TokenStorage::ARENAS;
+        InputMode input_mode = InputMode::READ;
+        MapOptions map_options;
+        PipelineOptions pipeline_options;
+        bool validate_utf8 = true;
+        int64_t utf8_error = -1;  // 마지막 로드에서 처음 잘못된 UTF-8 문자의 위치
+        bool json_lines = false;
+        RecordIndex window_records;  // ScanWindows 에서 창마다 다시 쓴다
+        int64_t record_error = -1;   // 마지막 ScanWindows 에서 처음 어긋난 레코드 위치
+        LoadStats* stats = nullptr;  // 계측 (SetStats). nullptr 이면 시계도 읽지 않는다
+        int numa_nodes = 0;          // NumaNodeCount (0 : 아직 세지 않음)
+        bool incremental = false;
+        AppendState appended;        // 이어 읽기의 기준 (마지막 로드)
 
-            _last_state[0] = state;
-            _token_arr_size[0] = count;
+    public:
+        explicit BasicInFileReserver() = default;
+
+        // 워커를 CPU 코어에 고정할지 (첫 로드 전에 설정)
+        void SetPinThreads(bool on) { pool.SetPinThreads(on); }
+        void SetChunkPolicy(const ChunkPolicy& policy) { chunk_policy = policy; }
+        // NUMA 배치 (ChunkPolicy::numa, 기본 꺼짐) : READ 입력은 워커마다 자기 청크 구간을 직접 읽어 그 워커의 노드에 두고,
+        // ARENAS 토큰 아레나는 스캔하는 워커의 노드로 옮긴다. 워커 고정(SetPinThreads)이 켜져 있어야 의미가 있다
+        void SetNumaPlacement(bool on) { chunk_policy.numa = on; }
+        // 이어 읽기 (기본 꺼짐) : 같은 파일을 READ 로 다시 읽을 때 뒤에 덧붙기만 했으면 덧붙은 부분만 읽고 스캔한다.
+        // 연속 배열 operator() 에만 해당하며, 앞부분이 바뀌었거나 다른 파일이면 처음부터 읽는다
+        void SetIncremental(bool on) { incremental = on; if (!on) appended.valid = false; }
+        void SetTokenStorage(TokenStorage storage) { token_storage = storage; }
+        void SetInputMode(InputMode mode) { input_mode = mode; }
+        void SetMapOptions(const MapOptions& options) { map_options = options; }
+        void SetPipelineOptions(const PipelineOptions& options) { pipeline_options = options; }
+        // stage 1 에서 UTF-8 도 검증한다 (기본). 잘못된 입력이면 로드가 실패하고 GetUtf8Error 가 위치를 준다
+        void SetValidateUtf8(bool on) { validate_utf8 = on; }
+        // 마지막 로드에서 처음 잘못된 UTF-8 문자의 위치 (BOM 제외). 없거나 검증하지 않았으면 -1
+        int64_t GetUtf8Error() const { return utf8_error; }
+        // stage 1 에서 토큰마다 TokenType 한 바이트도 쓴다 (토큰 배열 옆의 별도 배열, 기본 꺼짐).
+        // 테이프 / 괄호 인덱스 / 스칼라 값 / 커서가 입력을 다시 읽지 않고 종류를 안다
+        void SetTokenTypes(bool on) { token_dense.typed = on; }
+        // 연속 토큰 배열과 같은 자리의 종류 배열 (types[token_len] == END). 켜지 않았으면 nullptr.
+        // 다음 로드 전까지 유효하며, 조각 결과만 받은 로드(연속 배열을 만들지 않음)에는 해당하지 않는다
+        const uint8_t* GetTokenTypes() const { return token_dense.typed ? token_dense.types : nullptr; }
+        // 입력이 JSON Lines (줄마다 값 하나) 이다 (기본 꺼짐). 청크는 줄바꿈에서만 나누고
+        // 청크 시작은 문자열 밖으로 본다 → 시작 상태 추측과 재스캔이 없다. 레코드는 IndexRecords 로
+        void SetJsonLines(bool on) { json_lines = on; }
+        // 마지막 ScanWindows 에서 줄 하나에 값 하나가 아닌 첫 위치 (파일 안, BOM 제외). 없으면 -1
+        int64_t GetRecordError() const { return record_error; }
+        // 로드(operator() / ScanBuffer / ScanWindows)마다 out 을 다시 채운다. 그 뒤의 ParseTape 등은 자기 단계를 더한다.
+        // out 은 그동안 살아 있어야 하며, nullptr 이면 끈다 (기본)
+        void SetStats(LoadStats* out) { stats = out; }
+
+        // use_simd 가 true 일 때 쓸 ISA 를 명시적으로 고정 (CPU 가 지원하는 범위로 제한됨)
+        void SetSimdLevel(SimdLevel level) { simd_level = CpuFeatures::Clamp(level); }
+        SimdLevel GetSimdLevel() const { return simd_level; }
+
+        // 청크별 조각 그대로 (token_arr[i] 뒤에 각자 센티넬). 다음 로드나 Trim 전까지 유효
+        bool operator()(const std::string& fileName, int thr_num,
+            std::vector<Token*>& token_arr, int64_t& token_arr_len,
+            bool use_simd = true)
+        {
+            std::vector<int64_t> token_arr_sizes;
+            return Load(fileName, thr_num, use_simd ? simd_level : SimdLevel::SCALAR,
+                token_arr, token_arr_sizes, token_arr_len);
         }
 
-        // ── 병렬 스캐닝 메인 ───────────────────────────────────────────
-        static bool ScanningNew(char* text, int64_t length, int thr_num,
-            Token*& _tokens_orig, int64_t& _tokens_orig_size,
-            std::vector<Token*>& _token_arr, int64_t& _token_arr_size,
-            bool /*use_simd*/)
+        // 하나의 연속 배열 (tokens[token_len] == 파일 길이 센티넬). 다음 로드 전까지 유효
+        bool operator()(const std::string& fileName, int thr_num,
+            const Token*& tokens, int64_t& token_len,
+            bool use_simd = true)
         {
-            // 청크 경계 계산
-            std::vector<int64_t> start(thr_num);
-            std::vector<int64_t> last(thr_num);
+            const SimdLevel level = use_simd ? simd_level : SimdLevel::SCALAR;
+            bool ok = false;
+            if (incremental && TryAppend(fileName, thr_num, level, tokens, token_len, ok)) return ok;
 
-            start[0] = 0;
-            for (int i = 1; i < thr_num; ++i) {
-                start[i] = length / thr_num * i;
-                for (int64_t x = start[i]; x <= length; ++x) {
-                    if (Utility::isWhitespace(text[x]) ||
-                        LoadDataOption::LeftBracket == text[x] ||
-                        LoadDataOption::RightBracket == text[x] ||
-                        LoadDataOption::Comma == text[x] ||
-                        LoadDataOption::LeftBrace == text[x] ||
-                        LoadDataOption::RightBrace == text[x] ||
-                        LoadDataOption::Assignment == text[x]) {
-                        start[i] = x; break;
-                    }
-                    if (x == length) return false;
-                }
-            }
+            std::vector<Token*> token_arr;
+            std::vector<int64_t> token_arr_sizes;
+            int64_t token_arr_len = 0;
+            if (!Load(fileName, thr_num, level, token_arr, token_arr_sizes, token_arr_len)) return false;
+            if (!Densify(thr_num, token_arr, token_arr_sizes, token_arr_len, text_len, tokens, token_len)) return false;
+            if (incremental && input_mode == InputMode::READ) RememberAppend(fileName, tokens, token_len);
+            return true;
+        }
 
-            // 중복 제거
-            {
-                std::set<int64_t> _set(start.begin(), start.end());
-                thr_num = static_cast<int>(_set.size());
-                start.clear();
-                for (auto x : _set) start.push_back(x);
-                last.resize(thr_num);
-            }
-            for (int i = 0; i < thr_num - 1; ++i) last[i] = start[i + 1];
-            last[thr_num - 1] = length;
+        // 메모리에 이미 있는 입력을 스캔한다 (파일을 읽지 않음). 결과는 연속 배열 operator() 와 같다.
+        // data 는 다음 로드 전까지 살아 있어야 하며 GetBuffer() 가 그것을 가리킨다
+        bool ScanBuffer(const char* data, int64_t length, int thr_num,
+            const Token*& tokens, int64_t& token_len, bool use_simd = true)
+        {
+            utf8_error = -1;
+            strings.Reset();
+            if (stats) stats->Reset();
+            appended.valid = false;
+            mapping.Close();
+            text = nullptr;
+            text_len = 0;
+            if (!TokenFits<Token>(length)) return false;
+            text = data;
+            text_len = length;
 
-            // 토큰 버퍼 확보
-            int64_t now_capacity = length + thr_num + 1;
-            Token* tokens_orig = nullptr;
+            std::vector<Token*> token_arr;
+            std::vector<int64_t> token_arr_sizes;
+            int64_t token_arr_len = 0;
+            bool in_string = false;
+            if (!Scan(pool, text, text_len, in_string, thr_num, json_lines,
+                token_storage, arenas, token_dense,
+                token_arr, token_arr_sizes, token_arr_len, use_simd ? simd_level : SimdLevel::SCALAR, chunk_policy,
+                validate_utf8 ? &utf8_error : nullptr, stats)) return false;
+            return Densify(thr_num, token_arr, token_arr_sizes, token_arr_len, text_len, tokens, token_len);
+        }
 
-            if (_tokens_orig) {
-                if (_tokens_orig_size >= now_capacity) {
-                    tokens_orig = _tokens_orig;
-                }
-                else {
-                    free(_tokens_orig);
-                    tokens_orig = static_cast<Token*>(calloc(static_cast<size_t>(now_capacity), sizeof(Token)));
-                    _tokens_orig_size = now_capacity;
-                }
-            }
-            else {
-                tokens_orig = static_cast<Token*>(calloc(static_cast<size_t>(now_capacity), sizeof(Token)));
-                _tokens_orig_size = now_capacity;
-            }
-            if (!tokens_orig) return false;
+        // 단일 스레드 바이트 단위 스캐너 (비교 기준). text[length] 까지 읽으므로 NUL 로 끝나야 한다.
+        // tokens 는 (length + 1) 칸이며 free 로 돌려준다
+        static void ScanSerial(const char* text, int64_t length, Token*& tokens, int64_t& token_len) {
+            Scanning(text, length, tokens, token_len);
+        }
 
-            std::vector<Token*> tokens(thr_num);
-            tokens[0] = tokens_orig;
-            for (int64_t i = 1; i < thr_num; ++i)
-                tokens[i] = tokens[i - 1] + (last[i - 1] - start[i - 1]);
+        // ── 창 단위 스캔 (파일이 메모리보다 클 때) ─────────────────────
+        //  파일을 window_size 바이트 창으로 나눠 읽고, 창마다 병렬 스캔한 뒤 consume 에 넘기고
+        //  버퍼를 다시 쓴다. 메모리는 파일 크기가 아니라 창 크기로 정해진다.
+        //  - 창 끝은 창 안의 마지막 분할 가능 위치 : 그 뒤(잘린 토큰)는 다음 창 앞으로 옮긴다.
+        //    분할 가능 위치가 하나도 없으면 창을 두 배로 늘려 다시 읽는다.
+        //  - 분할 가능 위치는 역슬래시 바로 뒤가 아니고 word 중간도 아니므로, 창 사이에는
+        //    문자열 내부 여부만 넘기면 된다 (창은 순서대로 처리되므로 추측 없이 정확하다).
+        //  - Window::tokens 는 창 text 안의 오프셋, tokens[token_len] == 창 길이 센티넬.
+        //    파일 안 위치는 offset + 토큰. types 는 SetTokenTypes 를 켰을 때만 (아니면 nullptr).
+        //    포인터는 모두 consume 안에서만 유효.
+        //  - SetJsonLines 를 켜면 창 끝은 마지막 줄바꿈이라 창마다 온전한 레코드만 들어 있고,
+        //    records[0, record_len] 이 창 안의 레코드 인덱스다 (RecordIndex::Data 와 같은 모양, 센티넬 포함).
+        //    줄 하나에 값 하나가 아니면 그 창은 넘기지 않고 false (위치는 GetRecordError).
+        //  consume 이 false 를 돌려주면 거기서 멈춘다 (오류가 아니므로 true 반환).
+        //  잘못된 UTF-8 을 만나면 그 창은 consume 에 넘기지 않고 false (위치는 GetUtf8Error).
+        struct Window {
+            const char* text;
+            int64_t length;
+            int64_t offset;       // 파일 안에서 text[0] 의 위치 (BOM 제외)
+            const Token* tokens;
+            int64_t token_len;
+            const uint8_t* types;  // tokens 와 같은 자리의 TokenType
+            const int64_t* records;  // 레코드마다 첫 토큰 번호 (JSON Lines 일 때만, 아니면 nullptr)
+            int64_t record_len;
+        };
+        using WindowConsumer = std::function<bool(const Window&)>;
 
-            std::vector<std::array<int64_t, 1>> token_arr_size(thr_num);
-            std::vector<std::array<int, 1>>     last_state(thr_num);
-            std::vector<int64_t>                quote_count(thr_num, 0);
+        bool ScanWindows(const std::string& fileName, int thr_num, int64_t window_size,
+            const WindowConsumer& consume, bool use_simd = true)
+        {
+            text = nullptr;
+            text_len = 0;
+            utf8_error = -1;
+            record_error = -1;
+            strings.Reset();
+            if (stats) stats->Reset();
+            appended.valid = false;
+            mapping.Close();
 
-            // ── Stage 1 병렬 ─────────────────────────────────────────────
-            {
-                auto a = std::chrono::steady_clock::now();
-                std::vector<std::thread> thr(thr_num);
-                for (int i = 0; i < thr_num; ++i) {
-                    thr[i] = std::thread(ScanWithSimdJsonStyle,
-                        text + start[i], start[i], last[i] - start[i],
-                        tokens[i], std::ref(token_arr_size[i][0]), &quote_count[i]);
-                }
-                for (int i = 0; i < thr_num; ++i) thr[i].join();
+            clau_compat::ReadOnlyFile file;
+            if (!file.Open(fileName.c_str())) return false;
+            const int64_t size = file.Size();
+            if (size < 0) return false;
+
+            char head[3] = { 0 };
+            const int64_t head_len = std::min<int64_t>(size, 3);
+            if (head_len > 0 && !file.ReadAt(head, head_len, 0)) return false;
+            const int64_t bom = Utility::BomSize(head, head_len);
+            const int64_t file_length = size - bom;
 
-                auto b = std::chrono::steady_clock::now();
-                std::cout << "토큰 후보 배열 구성(parallel) \t"
-                    << std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count()
-                    << "ms\n";
+            int64_t capacity = std::min(std::max<int64_t>(window_size, 4096), std::max<int64_t>(file_length, 1));
+            if (!TokenFits<Token>(capacity)) return false;
+            if (!buffer || buffer_len < capacity) {
+                delete[] buffer;
+                buffer = new (std::nothrow) char[capacity + 1];
+                buffer_len = buffer ? capacity : 0;
             }
+            if (!buffer) return false;
+            capacity = buffer_len;
+            if (stats) stats->input_bytes = buffer_len + 1;
 
-            // ── Stage 2 병렬 ─────────────────────────────────────────────
-            {
-                auto a = std::chrono::steady_clock::now();
-                std::vector<std::thread> thr(thr_num);
+            const SimdLevel level = use_simd ? simd_level : SimdLevel::SCALAR;
+            std::vector<Token*> token_arr;
+            std::vector<int64_t> token_arr_sizes;
+            bool in_string = false;
+            int64_t offset = 0;  // buffer[0] 의 파일 안 위치
+            int64_t have = 0;    // buffer 에 들어 있는 바이트 수
 
-                thr[0] = std::thread(_Scanning2,
-                    text + start[0], start[0], last[0] - start[0],
-                    std::ref(tokens[0]), token_arr_size[0][0],
-                    std::ref(token_arr_size[0]),
-                    0 == thr_num - 1, std::ref(last_state[0]), 0, int64_t(0));
+            while (have > 0 || offset + have < file_length) {
+                const int64_t read_start = LoadStats::Clock(stats);
+                const int64_t want = std::min(capacity - have, file_length - (offset + have));
+                if (want > 0 && !file.ReadAt(buffer + have, want, bom + offset + have)) return false;
+                have += want;
 
-                for (int i = 1; i < thr_num; ++i) {
-                    quote_count[i] += quote_count[i - 1];
-                    thr[i] = std::thread(_Scanning2,
-                        text + start[i], start[i], last[i] - start[i],
-                        std::ref(tokens[i]), token_arr_size[i][0],
-                        std::ref(token_arr_size[i]),
-                        i == thr_num - 1, std::ref(last_state[i]), i,
-                        quote_count[i - 1]);
+                int64_t cut = have;
+                if (offset + have < file_length) {
+                    cut = LastSplitPoint(buffer, have, json_lines);
+                    if (cut == 0) {  // 창 전체가 하나의 토큰 조각 → 창을 늘린다
+                        const int64_t grown = capacity * 2;
+                        if (!TokenFits<Token>(grown)) return false;
+                        char* bigger = new (std::nothrow) char[grown + 1];
+                        if (!bigger) return false;
+                        memcpy(bigger, buffer, static_cast<size_t>(have));
+                        delete[] buffer;
+                        buffer = bigger;
+                        buffer_len = capacity = grown;
+                        if (stats) stats->input_bytes = buffer_len + 1;
+                        continue;
+                    }
                 }
-                for (int i = 0; i < thr_num; ++i) thr[i].join();
 
-                auto b = std::chrono::steady_clock::now();
-                std::cout << "토큰 배열 구성(parallel) \t"
-                    << std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count()
-                    << "ms\n";
-            }
+                int64_t token_arr_len = 0;
+                const Token* tokens = nullptr;
+                int64_t token_len = 0;
+                int64_t window_error = -1;
+                const int64_t read_end = LoadStats::Clock(stats);
+                if (stats) stats->read_ns += read_end - read_start;
+                if (!Scan(pool, buffer, cut, in_string, thr_num, json_lines,
+                    token_storage, arenas, token_dense,
+                    token_arr, token_arr_sizes, token_arr_len, level, chunk_policy,
+                    validate_utf8 ? &window_error : nullptr, stats)) {
+                    if (window_error >= 0) utf8_error = offset + window_error;
+                    return false;
+                }
+                if (!Densify(thr_num, token_arr, token_arr_sizes, token_arr_len, cut, tokens, token_len)) return false;
 
-            // ── 청크 간 state 연결 (sequential) ──────────────────────────
-            {
-                auto a = std::chrono::steady_clock::now();
-
-                int state = static_cast<int>(quote_count[0] % 2);
-                for (int i = 1; i < thr_num; ++i) {
-                    if (state == 1) {
-                        auto& sz = token_arr_size[i - 1][0];
-                        if (sz > 0) {
-                            auto _start = tokens[i - 1][sz - 1];
-                            sz--;
-                            tokens[i][0] = _start;
-                        }
-                        else {
-                            std::cout << "chk ...........1\n";
-                        }
+                if (json_lines) {
+                    const int64_t a = LoadStats::Clock(stats);
+                    int64_t error = -1;
+                    if (!BuildRecordIndex(pool, buffer, tokens, GetTokenTypes(), token_len, thr_num, window_records, error))
+                        return false;
+                    if (stats) {
+                        stats->records_ns += LoadStats::Clock(stats) - a;
+                        stats->record_bytes = std::max(stats->record_bytes, (window_records.Size() + 1) * int64_t(sizeof(int64_t)));
                     }
-                    state = static_cast<int>(quote_count[i] % 2);
+                    if (error >= 0) { record_error = offset + error; return false; }
                 }
 
-                auto b = std::chrono::steady_clock::now();
-                std::cout << "state에 맞게 연결?(sequential) \t"
-                    << std::chrono::duration_cast<std::chrono::milliseconds>(b - a).count()
-                    << "ms\n";
-                std::cout << "state is " << state << "\n";
-            }
+                if (!consume(Window{ buffer, cut, offset, tokens, token_len, GetTokenTypes(),
+                    json_lines ? window_records.Data() : nullptr, json_lines ? window_records.Size() : 0 })) return true;
 
-            // 센티넬(다음 토큰 시작 위치) 설정
-            int64_t real_token_arr_count = 0;
-            for (int t = 0; t < thr_num; ++t) real_token_arr_count += token_arr_size[t][0];
+                memmove(buffer, buffer + cut, static_cast<size_t>(have - cut));
+                offset += cut;
+                have -= cut;
+            }
+            return true;
+        }
 
-            for (int t = 0; t < thr_num; ++t) {
-                if (t < thr_num - 1 && token_arr_size[t][0] > 0)
-                    tokens[t][token_arr_size[t][0]] = tokens[t + 1][0];
-                else if (token_arr_size[t][0] > 0)
-                    tokens[t][token_arr_size[t][0]] = static_cast<Token>(length);
+        // 마지막 로드의 연속 토큰 배열로 테이프를 만든다 (괄호 짝이 맞지 않으면 false).
+        // 테이프의 오프셋은 GetBuffer() 안의 위치이므로 다음 로드 전까지만 해석할 수 있다.
+        // types (GetTokenTypes) 를 주면 토큰 종류를 입력 대신 거기서 읽는다 (아래 둘도 같다)
+        bool ParseTape(int thr_num, const Token* tokens, int64_t token_len, Tape& tape,
+            const uint8_t* types = nullptr)
+        {
+            if (!text && token_len > 0) return false;
+            const int64_t a = LoadStats::Clock(stats);
+            const bool ok = BuildTape(pool, text, tokens, types, token_len, std::max(thr_num, 1), tape);
+            if (stats) {
+                stats->tape_ns += LoadStats::Clock(stats) - a;
+                stats->tape_bytes = tape.Size() * int64_t(sizeof(uint64_t));
             }
+            return ok;
+        }
 
-            _token_arr = tokens;
-            _token_arr_size = real_token_arr_count;
-            _tokens_orig = tokens_orig;
-            return true;
+        // 마지막 로드의 연속 토큰 배열로 괄호 짝 인덱스를 만든다 (괄호 짝이 맞지 않으면 false)
+        bool IndexBrackets(int thr_num, const Token* tokens, int64_t token_len, BracketIndex& index,
+            const uint8_t* types = nullptr)
+        {
+            if (!text && token_len > 0) return false;
+            const int64_t a = LoadStats::Clock(stats);
+            const bool ok = BuildBracketIndex(pool, text, tokens, types, token_len, std::max(thr_num, 1), index);
+            if (stats) {
+                stats->brackets_ns += LoadStats::Clock(stats) - a;
+                stats->bracket_bytes = index.Size() * int64_t(sizeof(Token));
+            }
+            return ok;
         }
 
-        // ── 단일 스레드 스캐너 (Scanning / Scanning2) ─────────────────
-        static void Scanning(char* text, const int64_t length,
-            Token*& _token_arr, int64_t& _token_arr_size)
+        // 마지막 로드의 연속 토큰 배열로 스칼라 값 배열을 만든다 (메모리 부족이면 false).
+        // 잘못된 리터럴 / 숫자는 ScalarValues::FirstInvalid 로 알린다
+        bool ParseScalars(int thr_num, const Token* tokens, int64_t token_len, ScalarValues& scalars,
+            const uint8_t* types = nullptr)
         {
-            Token* token_arr = static_cast<Token*>(calloc(static_cast<size_t>(length + 1), sizeof(Token)));
-            int64_t token_arr_count = 0;
-            int     state = 0;
-            int64_t token_first = 0;
-            int64_t token_last = -1;
+            if (!text && token_len > 0) return false;
+            const int64_t a = LoadStats::Clock(stats);
+            const bool ok = BuildScalarValues(pool, text, tokens, types, token_len, std::max(thr_num, 1), scalars);
+            if (stats) {
+                stats->scalars_ns += LoadStats::Clock(stats) - a;
+                stats->scalar_bytes = scalars.Size() * int64_t(sizeof(uint8_t) + sizeof(ScalarValue));
+            }
+            return ok;
+        }
 
-            for (int64_t i = 0; i <= length; ++i) {
-                const char ch = text[i];
+        // 마지막 로드의 연속 토큰 배열이 JSON 문법에 맞는지 병렬로 검사한다 (최상위 값은 하나, SetJsonLines 이면 여러 개).
+        // 틀리면 false 와 함께 error 에 처음 틀린 토큰의 오프셋 (입력이 값 중간에 끝나면 입력 길이), 맞으면 -1
+        bool ValidateGrammar(int thr_num, const Token* tokens, int64_t token_len, int64_t& error,
+            const uint8_t* types = nullptr)
+        {
+            error = -1;
+            if (!text && token_len > 0) return false;
+            const int64_t a = LoadStats::Clock(stats);
+            BuildGrammarCheck(pool, text, text_len, tokens, types, token_len, std::max(thr_num, 1), json_lines, error);
+            if (stats) stats->grammar_ns += LoadStats::Clock(stats) - a;
+            return error < 0;
+        }
 
-                if (state == 0) {
-                    if ('"' == ch) {
-                        token_last = i - 1;
-                        if (token_last - token_first + 1 > 0)
-                            token_arr[token_arr_count++] = Utility::Get(token_first, token_last - token_first + 1, text);
-                        token_first = i; token_last = i; state = 1;
-                    }
-                    else if (Utility::isWhitespace(ch)) {
-                        token_last = i - 1;
-                        if (token_last - token_first + 1 > 0)
-                            token_arr[token_arr_count++] = Utility::Get(token_first, token_last - token_first + 1, text);
-                        token_first = token_last = i + 1;
-                    }
-                    else if (LoadDataOption::LeftBrace == ch || LoadDataOption::LeftBracket == ch ||
-                        LoadDataOption::RightBrace == ch || LoadDataOption::RightBracket == ch ||
-                        LoadDataOption::Assignment == ch || LoadDataOption::Comma == ch) {
-                        token_last = i - 1;
-                        if (token_last - token_first + 1 > 0)
-                            token_arr[token_arr_count++] = Utility::Get(token_first, token_last - token_first + 1, text);
-                        token_arr[token_arr_count++] = Utility::Get(i, 1, text);
-                        token_first = token_last = i + 1;
-                    }
-                }
-                else if (state == 1) {
-                    if ('\\' == ch) {
-                        state = 2;
-                    }
-                    else if ('"' == ch) {
-                        token_last = i;
-                        token_arr[token_arr_count++] = Utility::Get(token_first, token_last - token_first + 1, text);
-                        token_first = token_last = i + 1;
-                        state = 0;
-                    }
-                }
-                else if (state == 2) {
-                    state = 1;
-                }
+        // 마지막 로드의 연속 토큰 배열에서 레코드(줄마다 최상위 값 하나)를 찾는다 (메모리 부족이면 false).
+        // 줄 하나에 값이 하나가 아니면 (값이 여러 줄에 걸치거나 한 줄에 둘 이상) error 에 처음 어긋난 토큰의 오프셋
+        bool IndexRecords(int thr_num, const Token* tokens, int64_t token_len, RecordIndex& records, int64_t& error,
+            const uint8_t* types = nullptr)
+        {
+            error = -1;
+            if (!text && token_len > 0) return false;
+            const int64_t a = LoadStats::Clock(stats);
+            const bool ok = BuildRecordIndex(pool, text, tokens, types, token_len, std::max(thr_num, 1), records, error);
+            if (stats) {
+                stats->records_ns += LoadStats::Clock(stats) - a;
+                stats->record_bytes = (records.Size() + 1) * int64_t(sizeof(int64_t));
             }
+            return ok;
+        }
 
-            if (length - 1 - token_first + 1 > 0)
-                token_arr[token_arr_count++] = Utility::Get(token_first, length - 1 - token_first + 1, text);
+        // 레코드를 워커들이 나눠 consume(worker, record) 에 넘긴다 (블록 단위 work stealing, 순서는 정해지지 않음).
+        // worker 는 [0, thr_num) 이라 워커별 상태를 고를 수 있다. consume 은 예외를 던지면 안 되며,
+        // false 를 돌려주면 모든 워커가 멈추고 false
+        bool ForEachRecord(int thr_num, const RecordIndex& records, const std::function<bool(int, int64_t)>& consume) {
+            const int64_t block = 256;
+            const int64_t block_num = (records.Size() + block - 1) / block;
+            thr_num = static_cast<int>(std::max<int64_t>(1, std::min<int64_t>(thr_num, block_num)));
 
-            _token_arr = token_arr;
-            _token_arr_size = token_arr_count;
+            std::atomic<bool> stop{ false };
+            StealingScheduler sched;
+            sched.Reset(block_num, thr_num);
+            pool.Run(thr_num, [&](int w) {
+                int64_t k;
+                while (!stop.load(std::memory_order_relaxed) && sched.Next(w, k)) {
+                    const int64_t end = std::min(records.Size(), (k + 1) * block);
+                    for (int64_t r = k * block; r < end; ++r)
+                        if (!consume(w, r)) { stop = true; break; }
+                }
+                });
+            return !stop;
         }
 
-        // ── 파일 로드 & 스캔 ───────────────────────────────────────────
-        static std::pair<bool, int> Scan(FILE* inFile, int thr_num,
-            char*& _buffer, int64_t& _buffer_len,
-            Token*& _token_orig, int64_t& _token_orig_len,
-            std::vector<Token*>& _token_arr, int64_t& _token_arr_len,
-            bool use_simd)
-        {
-            if (!inFile) return { false, 0 };
+        // 청크별 토큰 아레나를 돌려준다 (ARENAS 모드의 조각 결과는 무효). 연속 배열은 유지
+        void Trim() {
+            for (auto& arena : arenas) arena.Release();
+            arenas.clear();
+        }
 
-            fseek(inFile, 0, SEEK_END);
-            int64_t file_length = CLAU_FTELL64(inFile);
-            fseek(inFile, 0, SEEK_SET);
+        // 이번 로드의 입력 (BOM 제외). 토큰은 이 안의 오프셋이며, 다음 로드 전까지 유효
+        const char* GetBuffer() const { return text; }
+        int64_t GetBufferLength() const { return text_len; }
 
-            if (Utility::ReadBom(inFile) == Utility::BomType::UTF_8)
-                file_length -= 3;
+        // 이번 로드의 문자열 아레나 (커서가 escape 를 풀어 쓴다). 로드할 때 비워지며 블록은 재사용.
+        // 아레나는 스레드 안전하지 않으므로 여러 스레드에서 읽을 때는 스레드마다 StringArena 를 따로 쓴다
+        StringArena* GetStringArena() const { return &strings; }
+    };
 
-            char* buffer = nullptr;
-            if (_buffer && _buffer_len >= file_length) {
-                buffer = _buffer;
-            }
-            else {
-                delete[] _buffer; _buffer = nullptr;
-                buffer = new (std::nothrow) char[file_length + 1];
-                _buffer = buffer;
-            }
 
-            if (!buffer) { fclose(inFile); return { false, 1 }; }
+    using InFileReserver = BasicInFileReserver<Token>;
+    using InFileReserver64 = BasicInFileReserver<Token64>;
+    using Cursor = BasicCursor<Token>;
+    using Cursor64 = BasicCursor<Token64>;
 
-            int a = clock();
-            fread(buffer, sizeof(char), static_cast<size_t>(file_length), inFile);
-            int b = clock();
-            std::cout << "load file \t" << b - a << "ms \tfile size " << file_length << "\n";
-            fclose(inFile);
-            buffer[file_length] = '\0';
 
-            int64_t token_arr_size = 0;
-            ScanningNew(buffer, file_length, thr_num,
-                _token_orig, _token_orig_len,
-                _token_arr, token_arr_size, use_simd);
+    template <class TokenT>
+    class BasicLoadData {
+    private:
+        BasicInFileReserver<TokenT> ifReserver;
+        Tape tape;
+        BasicBracketIndex<TokenT> brackets;
+        bool bracket_index = false;
+        ScalarValues scalars;
+        bool scalar_values = false;
+        bool validate_grammar = true;
+        int64_t syntax_error = -1;
+        RecordIndex records;
+        bool json_lines = false;
+        LoadStats stats;
+        bool collect_stats = false;
+        const TokenT* tokens = nullptr;
+        int64_t token_len = 0;
 
-            _buffer = buffer;
-            _buffer_len = file_length;
-            _token_arr_len = token_arr_size;
+        BasicCursor<TokenT> At(int64_t token, StringArena* strings) const {
+            return BasicCursor<TokenT>(GetBuffer(), GetBufferLength(), tokens, token_len,
+                bracket_index ? &brackets : nullptr, scalar_values ? &scalars : nullptr, strings,
+                GetTokenTypes(), token);
+        }
+    public:
+        BasicLoadData() = default;
 
-            return { true, 1 };
+        void SetSimdLevel(SimdLevel level) { ifReserver.SetSimdLevel(level); }
+        void SetPinThreads(bool on) { ifReserver.SetPinThreads(on); }
+        void SetNumaPlacement(bool on) { ifReserver.SetNumaPlacement(on); }
+        // 같은 파일을 다시 로드할 때 덧붙은 부분만 읽고 스캔한다 (InputMode::READ). 문법 검증 / 테이프 등은 전체로 다시 만든다
+        void SetIncremental(bool on) { ifReserver.SetIncremental(on); }
+        void SetTokenStorage(TokenStorage storage) { ifReserver.SetTokenStorage(storage); }
+        void SetInputMode(InputMode mode) { ifReserver.SetInputMode(mode); }
+        void SetMapOptions(const MapOptions& options) { ifReserver.SetMapOptions(options); }
+        void SetPipelineOptions(const PipelineOptions& options) { ifReserver.SetPipelineOptions(options); }
+        void SetValidateUtf8(bool on) { ifReserver.SetValidateUtf8(on); }
+        // stage 1 에서 토큰 종류 배열도 만든다 (토큰당 1바이트). 테이프 / 인덱스 / 커서가 입력을 다시 읽지 않는다
+        void SetTokenTypes(bool on) { ifReserver.SetTokenTypes(on); }
+        // 스캔 뒤 JSON 문법을 병렬로 검사한다 (기본). 틀리면 로드가 실패하고 GetSyntaxError 가 위치를 준다
+        void SetValidateGrammar(bool on) { validate_grammar = on; }
+        // 입력을 JSON Lines 로 읽는다 : 줄바꿈에서만 청크를 나누고, 로드할 때 레코드 인덱스를 만든다.
+        // 줄 하나에 값 하나가 아니면 로드가 실패하고 GetSyntaxError 가 위치를 준다
+        void SetJsonLines(bool on) { json_lines = on; ifReserver.SetJsonLines(on); if (!on) records.Release(); }
+        // 로드마다 단계별 시간 / 워커별 몫 / 할당 크기를 GetStats 에 채운다 (기본 꺼짐 : 시계도 읽지 않는다).
+        // hardware_counters 를 켜면 stage 1 워커의 perf 카운터도 읽는다 (Linux, 권한이 있을 때만)
+        void SetStats(bool on, bool hardware_counters = false) {
+            collect_stats = on;
+            stats.Reset();
+            stats.hardware_counters = on && hardware_counters;
+            ifReserver.SetStats(on ? &stats : nullptr);
         }
+        // 로드할 때 괄호 짝 인덱스도 만든다 (토큰 배열과 같은 크기의 메모리를 더 쓴다)
+        void SetBracketIndex(bool on) { bracket_index = on; if (!on) brackets.Release(); }
+        // 로드할 때 숫자 / 리터럴도 해석한다 (토큰당 9바이트). 잘못된 값이 있으면 로드가 실패하고 GetSyntaxError 가 그 토큰 위치를 준다
+        void SetScalarValues(bool on) { scalar_values = on; if (!on) scalars.Release(); }
+        SimdLevel GetSimdLevel() const { return ifReserver.GetSimdLevel(); }
 
-    public:
-        explicit InFileReserver() = default;
+        // 마지막 로드 결과 (다음 로드 전까지 유효). 테이프 payload 는 GetBuffer() 안의 오프셋
+        const Tape& GetTape() const { return tape; }
+        const TokenT* GetTokens() const { return tokens; }
+        const uint8_t* GetTokenTypes() const { return tokens ? ifReserver.GetTokenTypes() : nullptr; }
+        int64_t GetTokenLength() const { return token_len; }
+        const BasicBracketIndex<TokenT>& GetBracketIndex() const { return brackets; }
+        const ScalarValues& GetScalarValues() const { return scalars; }
+        const RecordIndex& GetRecords() const { return records; }
+        // 마지막 로드의 계측 (SetStats 를 켰을 때만 채운다. 실패한 로드는 거기까지의 단계만)
+        const LoadStats& GetStats() const { return stats; }
+        // 마지막 로드에서 처음 문법에 어긋난 바이트 오프셋 (BOM 제외). 없거나 검사하지 않았으면 -1.
+        // 문법 검증을 끄고 괄호 짝만 어긋났으면 위치를 모르므로 입력 길이 (GetBufferLength)
+        int64_t GetSyntaxError() const { return syntax_error; }
+        // 마지막 로드에서 처음 잘못된 UTF-8 바이트 오프셋 (BOM 제외). 없거나 검증하지 않았으면 -1
+        int64_t GetUtf8Error() const { return ifReserver.GetUtf8Error(); }
 
-        bool operator()(const std::string& fileName, int thr_num,
-            std::vector<Token*>& token_arr, int64_t& token_arr_len)
-        {
-            // Windows / POSIX 공용 fopen
-            FILE* inFile = nullptr;
-            CLAU_FOPEN(inFile, fileName.c_str(), "rb");
-            if (!inFile) return false;
+        // 마지막 로드의 최상위 값 (괄호 짝 인덱스 / 스칼라 값 배열이 있으면 그것을 쓴다)
+        BasicCursor<TokenT> Root() const { return At(0, ifReserver.GetStringArena()); }
 
-            return Scan(inFile, thr_num,
-                buffer, buffer_len,
-                token_orig, token_orig_len,
-                token_arr, token_arr_len, false).second > 0;
+        // JSON Lines 로드의 r 번째 레코드 값 (범위 밖이면 Valid() == false)
+        BasicCursor<TokenT> Record(int64_t r) const {
+            if (r < 0 || r >= records.Size()) return BasicCursor<TokenT>();
+            return At(records.First(r), ifReserver.GetStringArena());
         }
-    };
 
-
-    class LoadData {
-    private:
-        InFileReserver ifReserver;
-    public:
-        LoadData() = default;
+        // JSON Lines 로드의 레코드들을 thr_num 스레드가 나눠 consume(레코드 번호, 값) 에 넘긴다 (순서 없음).
+        // 스레드마다 문자열 아레나를 따로 주므로 꺼낸 문자열은 consume 안에서만 유효하다.
+        // consume 은 예외를 던지면 안 되며, false 를 돌려주면 멈추고 false
+        bool ForEachRecord(int thr_num, const std::function<bool(int64_t, const BasicCursor<TokenT>&)>& consume) {
+            if (thr_num <= 0) thr_num = static_cast<int>(std::thread::hardware_concurrency());
+            if (thr_num <= 0) thr_num = 1;
+            std::vector<StringArena> arenas(static_cast<size_t>(thr_num));
+            return ifReserver.ForEachRecord(thr_num, records, [&](int w, int64_t r) {
+                return consume(r, At(records.First(r), &arenas[w]));
+                });
+        }
+        const char* GetBuffer() const { return ifReserver.GetBuffer(); }
+        int64_t GetBufferLength() const { return ifReserver.GetBufferLength(); }
 
         bool LoadDataFromFile(const std::string& fileName,
             int lex_thr_num = 1,
@@ -847,13 +5204,47 @@ namespace clau {
                 parse_thr_num = static_cast<int>(std::thread::hardware_concurrency());
             if (parse_thr_num <= 0) parse_thr_num = 1;
 
-            int a = clock();
+            const int64_t a = LoadStats::Clock(collect_stats ? &stats : nullptr);
             try {
                 int64_t token_arr_len = 0;
-                std::vector<Token*> token_arr;
-                ifReserver(fileName, lex_thr_num, token_arr, token_arr_len);
-                int b = clock();
-                std::cout << b - a << "ms\n";
+                const TokenT* token_arr = nullptr;
+                tape.Resize(0);
+                brackets.Resize(0);
+                scalars.Resize(0);
+                records.Resize(0);
+                tokens = nullptr;
+                token_len = 0;
+                syntax_error = -1;
+                if (!ifReserver(fileName, lex_thr_num, token_arr, token_arr_len, use_simd)) return false;
+                const uint8_t* types = ifReserver.GetTokenTypes();
+                if (validate_grammar && !ifReserver.ValidateGrammar(parse_thr_num, token_arr, token_arr_len, syntax_error, types))
+                    return false;
+                if (json_lines) {
+                    if (!ifReserver.IndexRecords(parse_thr_num, token_arr, token_arr_len, records, syntax_error, types)) return false;
+                    if (syntax_error >= 0) {
+                        records.Resize(0);
+                        return false;
+                    }
+                }
+                if (!ifReserver.ParseTape(parse_thr_num, token_arr, token_arr_len, tape, types)) {
+                    syntax_error = ifReserver.GetBufferLength();  // 괄호 짝이 안 맞음 : 위치를 모르므로 입력 끝
+                    return false;
+                }
+                if (bracket_index && !ifReserver.IndexBrackets(parse_thr_num, token_arr, token_arr_len, brackets, types)) return false;
+                if (scalar_values) {
+                    if (!ifReserver.ParseScalars(parse_thr_num, token_arr, token_arr_len, scalars, types)) return false;
+                    if (scalars.FirstInvalid() >= 0) {
+                        syntax_error = token_arr[scalars.FirstInvalid()];
+                        scalars.Resize(0);
+                        return false;
+                    }
+                }
+                tokens = token_arr;
+                token_len = token_arr_len;
+                if (collect_stats) {
+                    stats.total_ns = LoadStats::Now() - a;
+                    stats.peak_rss = clau_compat::peak_rss();
+                }
             }
             catch (const char* err) { std::cout << err << "\n";       return false; }
             catch (const std::string& e) { std::cout << e << "\n";         return false; }
@@ -864,6 +5255,171 @@ namespace clau {
         }
     };
 
+
+    // 파일 크기를 보고 토큰 폭을 고른다 : 4GiB 이하 → 32비트, 초과 → 64비트
+    class LoadData {
+    private:
+        BasicLoadData<Token> load32;
+        std::unique_ptr<BasicLoadData<Token64>> load64;  // 큰 파일을 처음 만났을 때 생성
+        SimdLevel simd_level = CpuFeatures::Best();
+        bool pin_threads = true;
+        bool numa_placement = false;
+        bool incremental = false;
+        TokenStorage token_storage = TokenStorage::ARENAS;
+        InputMode input_mode = InputMode::READ;
+        MapOptions map_options;
+        PipelineOptions pipeline_options;
+        bool bracket_index = false;
+        bool scalar_values = false;
+        bool validate_utf8 = true;
+        bool token_types = false;
+        bool validate_grammar = true;
+        bool json_lines = false;
+        bool collect_stats = false;
+        bool hardware_counters = false;
+        bool wide = false;  // 마지막 로드가 64비트 토큰이었나
+
+        static int64_t FileLength(const std::string& fileName) {
+            FILE* inFile = nullptr;
+            CLAU_FOPEN(inFile, fileName.c_str(), "rb");
+            if (!inFile) return -1;
+            fseek(inFile, 0, SEEK_END);
+            const int64_t length = CLAU_FTELL64(inFile);
+            fclose(inFile);
+            return length;
+        }
+
+    public:
+        LoadData() = default;
+
+        void SetSimdLevel(SimdLevel level) {
+            simd_level = CpuFeatures::Clamp(level);
+            load32.SetSimdLevel(level);
+            if (load64) load64->SetSimdLevel(level);
+        }
+        void SetPinThreads(bool on) {
+            pin_threads = on;
+            load32.SetPinThreads(on);
+            if (load64) load64->SetPinThreads(on);
+        }
+        void SetNumaPlacement(bool on) {
+            numa_placement = on;
+            load32.SetNumaPlacement(on);
+            if (load64) load64->SetNumaPlacement(on);
+        }
+        void SetIncremental(bool on) {
+            incremental = on;
+            load32.SetIncremental(on);
+            if (load64) load64->SetIncremental(on);
+        }
+        void SetTokenStorage(TokenStorage storage) {
+            token_storage = storage;
+            load32.SetTokenStorage(storage);
+            if (load64) load64->SetTokenStorage(storage);
+        }
+        void SetInputMode(InputMode mode) {
+            input_mode = mode;
+            load32.SetInputMode(mode);
+            if (load64) load64->SetInputMode(mode);
+        }
+        void SetMapOptions(const MapOptions& options) {
+            map_options = options;
+            load32.SetMapOptions(options);
+            if (load64) load64->SetMapOptions(options);
+        }
+        void SetPipelineOptions(const PipelineOptions& options) {
+            pipeline_options = options;
+            load32.SetPipelineOptions(options);
+            if (load64) load64->SetPipelineOptions(options);
+        }
+        void SetBracketIndex(bool on) {
+            bracket_index = on;
+            load32.SetBracketIndex(on);
+            if (load64) load64->SetBracketIndex(on);
+        }
+        void SetScalarValues(bool on) {
+            scalar_values = on;
+            load32.SetScalarValues(on);
+            if (load64) load64->SetScalarValues(on);
+        }
+        void SetValidateUtf8(bool on) {
+            validate_utf8 = on;
+            load32.SetValidateUtf8(on);
+            if (load64) load64->SetValidateUtf8(on);
+        }
+        void SetTokenTypes(bool on) {
+            token_types = on;
+            load32.SetTokenTypes(on);
+            if (load64) load64->SetTokenTypes(on);
+        }
+        void SetValidateGrammar(bool on) {
+            validate_grammar = on;
+            load32.SetValidateGrammar(on);
+            if (load64) load64->SetValidateGrammar(on);
+        }
+        void SetJsonLines(bool on) {
+            json_lines = on;
+            load32.SetJsonLines(on);
+            if (load64) load64->SetJsonLines(on);
+        }
+        void SetStats(bool on, bool counters = false) {
+            collect_stats = on;
+            hardware_counters = counters;
+            load32.SetStats(on, counters);
+            if (load64) load64->SetStats(on, counters);
+        }
+        SimdLevel GetSimdLevel() const { return simd_level; }
+
+        // 마지막 로드 결과 (다음 로드 전까지 유효)
+        const Tape& GetTape() const { return wide ? load64->GetTape() : load32.GetTape(); }
+        const char* GetBuffer() const { return wide ? load64->GetBuffer() : load32.GetBuffer(); }
+        int64_t GetBufferLength() const { return wide ? load64->GetBufferLength() : load32.GetBufferLength(); }
+        int64_t GetSyntaxError() const { return wide ? load64->GetSyntaxError() : load32.GetSyntaxError(); }
+        int64_t GetUtf8Error() const { return wide ? load64->GetUtf8Error() : load32.GetUtf8Error(); }
+        const RecordIndex& GetRecords() const { return wide ? load64->GetRecords() : load32.GetRecords(); }
+        const LoadStats& GetStats() const { return wide ? load64->GetStats() : load32.GetStats(); }
+
+        // 마지막 로드가 4GiB 를 넘어 64비트 토큰을 썼으면 Root64, 아니면 Root 를 쓴다
+        bool IsWide() const { return wide; }
+        Cursor Root() const { return wide ? Cursor() : load32.Root(); }
+        Cursor64 Root64() const { return wide ? load64->Root() : Cursor64(); }
+        Cursor Record(int64_t r) const { return wide ? Cursor() : load32.Record(r); }
+        Cursor64 Record64(int64_t r) const { return wide ? load64->Record(r) : Cursor64(); }
+
+        bool LoadDataFromFile(const std::string& fileName,
+            int lex_thr_num = 1,
+            int parse_thr_num = 1,
+            bool use_simd = false)
+        {
+            const int64_t length = FileLength(fileName);
+            if (length < 0) return false;
+
+            wide = !TokenFits<Token>(length);
+            if (!wide)
+                return load32.LoadDataFromFile(fileName, lex_thr_num, parse_thr_num, use_simd);
+
+            if (!load64) {
+                load64 = std::make_unique<BasicLoadData<Token64>>();
+                load64->SetSimdLevel(simd_level);
+                load64->SetPinThreads(pin_threads);
+                load64->SetNumaPlacement(numa_placement);
+                load64->SetIncremental(incremental);
+                load64->SetTokenStorage(token_storage);
+                load64->SetInputMode(input_mode);
+                load64->SetMapOptions(map_options);
+                load64->SetPipelineOptions(pipeline_options);
+                load64->SetBracketIndex(bracket_index);
+                load64->SetScalarValues(scalar_values);
+                load64->SetValidateUtf8(validate_utf8);
+                load64->SetTokenTypes(token_types);
+                load64->SetValidateGrammar(validate_grammar);
+                load64->SetJsonLines(json_lines);
+                load64->SetStats(collect_stats, hardware_counters);
+            }
+            return load64->LoadDataFromFile(fileName, lex_thr_num, parse_thr_num, use_simd);
+        }
+    };
+
 } // namespace clau
 
 #endif // PARSER_H